@@ -28,6 +28,9 @@
 #include "audio/softsynth/opl/mame.h"
 
 #include "common/config-manager.h"
+#include "common/endian.h"
+#include "common/file.h"
+#include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 
@@ -41,12 +44,16 @@ enum OplEmulator {
 	kDOSBox = 2
 };
 
-OPL::OPL() {
+OPL::OPL() : _isWrapper(false) {
 	if (_hasInstance)
 		error("There are multiple OPL output instances running");
 	_hasInstance = true;
 }
 
+OPL::OPL(OPL *wrapped) : _isWrapper(true) {
+	assert(wrapped);
+}
+
 const Config::EmulatorDescription Config::_drivers[] = {
 	{ "auto", "<default>", kAuto, kFlagOpl2 | kFlagDualOpl2 | kFlagOpl3 },
 	{ "mame", _s("MAME OPL emulator"), kMame, kFlagOpl2 },
@@ -110,6 +117,118 @@ Config::DriverId Config::detect(OplType type) {
 	return drv;
 }
 
+static OPL *createEmulator(Config::DriverId driver, Config::OplType type) {
+	switch (driver) {
+	case kMame:
+		if (type == Config::kOpl2) {
+			return new MAME::OPL();
+		} else {
+			warning("MAME OPL emulator only supports OPL2 emulation");
+			return 0;
+		}
+
+#ifndef DISABLE_DOSBOX_OPL
+	case kDOSBox:
+		return new DOSBox::OPL(type);
+#endif
+
+	default:
+		warning("Unsupported OPL emulator %d", driver);
+		// TODO: Maybe we should add some dummy emulator too, which just outputs
+		// silence as sound?
+		return 0;
+	}
+}
+
+// Capture implementation
+
+static const uint32 kCaptureTag = MKTAG('O', 'P', 'L', 'C');
+static const byte kCaptureVersion = 1;
+
+/**
+ * Forwards everything to the actual emulator, and logs all writes along
+ * with the number of sample frames rendered so far.
+ */
+class CaptureOPL : public OPL {
+public:
+	CaptureOPL(OPL *opl, Config::OplType type, const Common::String &filename)
+		: OPL(opl), _opl(opl), _type(type), _filename(filename), _stereo(false), _sample(0) {
+	}
+
+	~CaptureOPL() {
+		if (_file.isOpen()) {
+			logEvent(Capture::kEventEnd, 0, 0);
+			_file.finalize();
+		}
+		delete _opl;
+	}
+
+	bool init(int rate) {
+		if (!_opl->init(rate))
+			return false;
+
+		Common::StackLock lock(_mutex);
+		if (!_file.isOpen()) {
+			if (!_file.open(_filename)) {
+				warning("Could not open OPL capture file '%s'", _filename.c_str());
+			} else {
+				_file.writeUint32BE(kCaptureTag);
+				_file.writeByte(kCaptureVersion);
+				_file.writeByte(_type);
+				_file.writeUint32LE(rate);
+			}
+		}
+		_stereo = _opl->isStereo();
+		return true;
+	}
+
+	void reset() {
+		logEvent(Capture::kEventReset, 0, 0);
+		_opl->reset();
+	}
+
+	void write(int a, int v) {
+		logEvent(Capture::kEventWrite, a, v);
+		_opl->write(a, v);
+	}
+
+	byte read(int a) {
+		return _opl->read(a);
+	}
+
+	void writeReg(int r, int v) {
+		logEvent(Capture::kEventWriteReg, r, v);
+		_opl->writeReg(r, v);
+	}
+
+	void readBuffer(int16 *buffer, int length) {
+		Common::StackLock lock(_mutex);
+		_opl->readBuffer(buffer, length);
+		_sample += _stereo ? length / 2 : length;
+	}
+
+	bool isStereo() const { return _opl->isStereo(); }
+
+private:
+	void logEvent(Capture::EventType type, int reg, int value) {
+		Common::StackLock lock(_mutex);
+		if (!_file.isOpen())
+			return;
+		_file.writeUint32LE(_sample);
+		_file.writeByte(type);
+		_file.writeByte(value);
+		_file.writeUint16LE(reg);
+	}
+
+	OPL *_opl;
+	Config::OplType _type;
+	Common::String _filename;
+	Common::DumpFile _file;
+	Common::Mutex _mutex;
+	bool _stereo;
+	uint32 _sample;
+};
+
 OPL *Config::create(OplType type) {
 	return create(kAuto, type);
 }
@@ -134,28 +253,77 @@ OPL *Config::create(DriverId driver, OplType type) {
 		}
 	}
 
-	switch (driver) {
-	case kMame:
-		if (type == kOpl2)
-			return new MAME::OPL();
-		else
-			warning("MAME OPL emulator only supports OPL2 emulation");
-			return 0;
+	OPL *opl = createEmulator(driver, type);
+	if (opl && ConfMan.hasKey("opl_capture"))
+		opl = new CaptureOPL(opl, type, ConfMan.get("opl_capture"));
 
-#ifndef DISABLE_DOSBOX_OPL
-	case kDOSBox:
-		return new DOSBox::OPL(type);
-#endif
+	return opl;
+}
 
-	default:
-		warning("Unsupported OPL emulator %d", driver);
-		// TODO: Maybe we should add some dummy emulator too, which just outputs
-		// silence as sound?
-		return 0;
+bool OPL::_hasInstance = false;
+
+bool Capture::load(Common::SeekableReadStream &stream) {
+	_events.clear();
+
+	if (stream.readUint32BE() != kCaptureTag || stream.readByte() != kCaptureVersion)
+		return false;
+	const byte type = stream.readByte();
+	if (type > Config::kOpl3)
+		return false;
+	_type = (Config::OplType)type;
+	_rate = stream.readUint32LE();
+
+	const uint32 count = (stream.size() - stream.pos()) / 8;
+	_events.reserve(count + 1);
+	for (uint32 i = 0; i < count; ++i) {
+		Event event;
+		event.sample = stream.readUint32LE();
+		event.type = stream.readByte();
+		event.value = stream.readByte();
+		event.reg = stream.readUint16LE();
+		_events.push_back(event);
 	}
+
+	if (stream.err() || _rate <= 0)
+		return false;
+
+	// Captures cut off by a crash lack the end marker
+	if (_events.empty() || _events.back().type != kEventEnd) {
+		Event event;
+		event.sample = _events.empty() ? 0 : _events.back().sample;
+		event.type = kEventEnd;
+		event.reg = event.value = 0;
+		_events.push_back(event);
+	}
+
+	return true;
 }
 
-bool OPL::_hasInstance = false;
+void Capture::replay(OPL *opl, int16 *buffer) const {
+	const int channels = opl->isStereo() ? 2 : 1;
+	uint32 sample = 0;
+
+	for (Common::Array<Event>::const_iterator i = _events.begin(); i != _events.end(); ++i) {
+		if (i->sample > sample) {
+			opl->readBuffer(buffer + sample * channels, (i->sample - sample) * channels);
+			sample = i->sample;
+		}
+
+		switch (i->type) {
+		case kEventWrite:
+			opl->write(i->reg, i->value);
+			break;
+		case kEventWriteReg:
+			opl->writeReg(i->reg, i->value);
+			break;
+		case kEventReset:
+			opl->reset();
+			break;
+		default:
+			break;
+		}
+	}
+}
 
 } // End of namespace OPL
 
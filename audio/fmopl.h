@@ -26,8 +26,13 @@
 #define SOUND_FMOPL_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/str.h"
 
+namespace Common {
+class SeekableReadStream;
+}
+
 namespace OPL {
 
 class OPL;
@@ -94,9 +99,25 @@ private:
 class OPL {
 private:
 	static bool _hasInstance;
+	bool _isWrapper;
+protected:
+	/**
+	 * For wrappers, which take ownership of the given emulator and forward
+	 * to it. They do not count as an instance of their own.
+	 */
+	explicit OPL(OPL *wrapped);
 public:
 	OPL();
-	virtual ~OPL() { _hasInstance = false; }
+	virtual ~OPL() {
+		if (!_isWrapper)
+			_hasInstance = false;
+	}
+
+	/**
+	 * Whether an OPL emulator exists already. Only one can exist at a
+	 * time, creating another one is an error.
+	 */
+	static bool hasInstance() { return _hasInstance; }
 
 	/**
 	 * Initializes the OPL emulator.
@@ -154,6 +175,58 @@ public:
 	virtual bool isStereo() const = 0;
 };
 
+/**
+ * A register stream captured from an OPL emulator.
+ *
+ * When the "opl_capture" config key is set to a file name, Config::create
+ * wraps the emulator, and all writes to it are logged to that file along
+ * with the output sample they happened at. This allows replaying the music
+ * of a game through all emulators, offline and as fast as possible.
+ */
+class Capture {
+public:
+	enum EventType {
+		kEventWrite,	// OPL::write, port and value
+		kEventWriteReg,	// OPL::writeReg, register and value
+		kEventReset,	// OPL::reset
+		kEventEnd		// End of the capture
+	};
+
+	struct Event {
+		uint32 sample;	// Sample frame the event happened before
+		uint8 type;
+		uint16 reg;
+		uint8 value;
+	};
+
+	/**
+	 * Loads a capture file.
+	 *
+	 * @return	true on success, false on failure
+	 */
+	bool load(Common::SeekableReadStream &stream);
+
+	Config::OplType getType() const { return _type; }
+	int getRate() const { return _rate; }
+
+	/**
+	 * Returns the length of the capture in sample frames.
+	 */
+	uint32 getLength() const { return _events.empty() ? 0 : _events.back().sample; }
+
+	/**
+	 * Replays the capture through an initialized emulator. The buffer has
+	 * to hold getLength() sample frames, i.e. twice as many samples for a
+	 * stereo emulator.
+	 */
+	void replay(OPL *opl, int16 *buffer) const;
+
+private:
+	Config::OplType _type;
+	int _rate;
+	Common::Array<Event> _events;
+};
+
 } // End of namespace OPL
 
 // Legacy API
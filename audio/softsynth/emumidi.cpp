@@ -0,0 +1,293 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+#include "audio/softsynth/emumidi.h"
+
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+// Amount of samples (per channel) rendered in one go by the render-ahead
+// timer. The mixer callback may have to wait for one such block.
+enum {
+	kRenderAheadBlock = 512
+};
+
+void MidiDriver_Emulated::setRenderAhead(uint ms) {
+	Common::TimerManager *timer = g_system->getTimerManager();
+
+	if (_renderBuffer) {
+		// Stop the timer first, removeTimerProc waits for a running
+		// callback to finish.
+		timer->removeTimerProc(&renderAheadTimer, this);
+
+		Common::StackLock lock(_renderMutex);
+		debug(1, "MidiDriver_Emulated: Render-ahead stopped, %d underruns (%d samples)", _underruns, _underrunSamples);
+		delete[] _renderBuffer;
+		_renderBuffer = 0;
+		_renderBufferSize = 0;
+		_renderReadPos = 0;
+		_renderFill = 0;
+
+		// Only called when the synth is about to be torn down, so the
+		// pending events do not matter anymore.
+		Common::StackLock queueLock(_queueMutex);
+		_queueEvents = false;
+		clearEventQueue();
+	}
+
+	if (!ms)
+		return;
+
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int samples = getRate() * ms / 1000;
+	samples = MAX<int>(kRenderAheadBlock, samples - samples % kRenderAheadBlock);
+
+	_renderBuffer = new int16[samples * stereoFactor];
+	_renderBufferSize = samples * stereoFactor;
+	_renderReadPos = 0;
+	_renderFill = 0;
+	_underruns = 0;
+	_underrunSamples = 0;
+
+	{
+		Common::StackLock lock(_queueMutex);
+		_playedSamples = 0;
+		_renderedSamples = 0;
+		_queueEvents = true;
+	}
+
+	// One block is rendered per tick, so ticking twice per block duration
+	// fills the buffer at twice the playback speed. When the timer falls
+	// behind, the timer manager catches up by calling us repeatedly, with
+	// the other timer callbacks getting their turn in between.
+	const int32 interval = MAX<int32>(1, kRenderAheadBlock * 500000 / getRate());
+	if (!timer->installTimerProc(&renderAheadTimer, interval, this)) {
+		warning("MidiDriver_Emulated: Could not install render-ahead timer");
+		Common::StackLock lock(_queueMutex);
+		_queueEvents = false;
+		delete[] _renderBuffer;
+		_renderBuffer = 0;
+		_renderBufferSize = 0;
+	}
+}
+
+void MidiDriver_Emulated::renderAheadTimer(void *refCon) {
+	((MidiDriver_Emulated *)refCon)->renderAhead();
+}
+
+void MidiDriver_Emulated::renderAhead() {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	Common::StackLock lock(_renderMutex);
+	if (!_renderBuffer || _renderFill == _renderBufferSize)
+		return;
+
+	const int writePos = (_renderReadPos + _renderFill) % _renderBufferSize;
+	int len = MIN(_renderBufferSize - _renderFill, _renderBufferSize - writePos);
+	len = MIN(len, kRenderAheadBlock * stereoFactor);
+
+	renderSamples(_renderBuffer + writePos, len);
+	_renderFill += len;
+}
+
+bool MidiDriver_Emulated::queueEvent(uint32 msg, const byte *sysExData, uint16 sysExLength) {
+	// The mutex is recursive and held by playDueEvents() the whole time,
+	// so this tells the events it plays apart from everything else. Other
+	// threads wait until it is done.
+	Common::StackLock lock(_queueMutex);
+	if (!_queueEvents || _playingEvents)
+		return false;
+
+	// Events sent from the player timer callback are in render time
+	// already, so they are due right away. For everything else, up to one
+	// buffer length past the mixer position may have been rendered, so
+	// that is the earliest time it can be played at. Using the same
+	// latency for all those events keeps their spacing intact.
+	QueuedEvent event;
+	if (_inTimerProc)
+		event.time = _timerProcTime;
+	else
+		event.time = _playedSamples + _renderBufferSize / (isStereo() ? 2 : 1);
+	event.msg = msg;
+	event.sysExData = 0;
+	event.sysExLength = sysExLength;
+	if (sysExData) {
+		event.sysExData = new byte[sysExLength];
+		memcpy(event.sysExData, sysExData, sysExLength);
+	}
+
+	EventQueue::iterator i = _eventQueue.begin();
+	while (i != _eventQueue.end() && (int32)(i->time - event.time) <= 0)
+		++i;
+	_eventQueue.insert(i, event);
+
+	return true;
+}
+
+int32 MidiDriver_Emulated::samplesUntilNextEvent() {
+	Common::StackLock lock(_queueMutex);
+	if (_eventQueue.empty())
+		return 0x7FFFFFFF;
+	return (int32)(_eventQueue.front().time - _renderedSamples);
+}
+
+void MidiDriver_Emulated::playDueEvents() {
+	Common::StackLock lock(_queueMutex);
+
+	_playingEvents = true;
+	while (!_eventQueue.empty() && (int32)(_eventQueue.front().time - _renderedSamples) <= 0) {
+		QueuedEvent event = _eventQueue.front();
+		_eventQueue.pop_front();
+		if (event.sysExData) {
+			sysEx(event.sysExData, event.sysExLength);
+			delete[] event.sysExData;
+		} else {
+			send(event.msg);
+		}
+	}
+	_playingEvents = false;
+}
+
+void MidiDriver_Emulated::clearEventQueue() {
+	for (EventQueue::iterator i = _eventQueue.begin(); i != _eventQueue.end(); ++i)
+		delete[] i->sysExData;
+	_eventQueue.clear();
+}
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	if (_renderBuffer) {
+		Common::StackLock lock(_renderMutex);
+
+		if (_renderBuffer) {
+			int left = numSamples;
+			while (left && _renderFill) {
+				int len = MIN(left, MIN(_renderFill, _renderBufferSize - _renderReadPos));
+				memcpy(data, _renderBuffer + _renderReadPos, len * sizeof(int16));
+				_renderReadPos = (_renderReadPos + len) % _renderBufferSize;
+				_renderFill -= len;
+				data += len;
+				left -= len;
+			}
+
+			// The buffer ran dry, so the synth is exactly at the position
+			// the mixer asks for. Render the rest right here.
+			if (left) {
+				++_underruns;
+				_underrunSamples += left;
+				renderSamples(data, left);
+			}
+
+			Common::StackLock queueLock(_queueMutex);
+			_playedSamples += numSamples / (isStereo() ? 2 : 1);
+
+			return numSamples;
+		}
+	}
+
+	renderSamples(data, numSamples);
+	return numSamples;
+}
+
+uint32 MidiDriver_Emulated::renderBenchmark(uint32 numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int16 *buffer = new int16[kRenderAheadBlock * stereoFactor];
+
+	_mixer->pauseHandle(_mixerSoundHandle, true);
+	Common::StackLock lock(_renderMutex);
+
+	// Keep the render clock in line with the mixer for event timestamps
+	const uint32 renderedSamples = _renderedSamples;
+	const uint32 start = g_system->getMillis();
+	while (numSamples) {
+		const uint32 len = MIN<uint32>(numSamples, kRenderAheadBlock);
+		renderSamples(buffer, len * stereoFactor);
+		numSamples -= len;
+	}
+	const uint32 elapsed = g_system->getMillis() - start;
+	{
+		Common::StackLock queueLock(_queueMutex);
+		_renderedSamples = renderedSamples;
+	}
+
+	_mixer->pauseHandle(_mixerSoundHandle, false);
+	delete[] buffer;
+
+	return elapsed;
+}
+
+void MidiDriver_Emulated::renderSamples(int16 *data, int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+	int step;
+
+	do {
+		playDueEvents();
+
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		// Stop at the next queued event, so it starts at the exact sample
+		const int32 untilEvent = samplesUntilNextEvent();
+		if (step > untilEvent)
+			step = untilEvent;
+
+		generateSamples(data, step);
+		{
+			Common::StackLock lock(_queueMutex);
+			_renderedSamples += step;
+		}
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			runTimerProc();
+			_nextTick += _samplesPerTick;
+		}
+
+		data += step * stereoFactor;
+		len -= step;
+	} while (len);
+}
+
+void MidiDriver_Emulated::runTimerProc() {
+	// The queue mutex must not be held while the callback runs, as it may
+	// wait for locks which other threads hold while sending events. The
+	// flag tells queueEvent() to make the events sent meanwhile due now.
+	{
+		Common::StackLock lock(_queueMutex);
+		_inTimerProc = true;
+		_timerProcTime = _renderedSamples;
+	}
+
+	if (_timerProc)
+		(*_timerProc)(_timerParam);
+
+	onTimer();
+
+	Common::StackLock lock(_queueMutex);
+	_inTimerProc = false;
+}
@@ -29,6 +29,9 @@
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
 
+#include "common/mutex.h"
+#include "common/list.h"
+
 #define FIXP_SHIFT 16
 
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
@@ -44,12 +47,89 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	// Render-ahead state, see setRenderAhead(). The render mutex guards
+	// the buffer and the synth, and is held while the player timer
+	// callback runs. The queue mutex guards the event queue and the
+	// fields used to timestamp events, and is never held while the timer
+	// callback runs, as engines send events with their own locks held.
+	// When both are needed, the render mutex is taken first.
+	Common::Mutex _renderMutex;
+	int16 *_renderBuffer;
+	int _renderBufferSize;
+	int _renderReadPos;
+	int _renderFill;
+	uint32 _underruns;
+	uint32 _underrunSamples;
+
+	// Sample clocks (per channel) of the mixer and of the synth, used to
+	// timestamp the events sent while rendering ahead.
+	uint32 _playedSamples;
+	uint32 _renderedSamples;
+
+	Common::Mutex _queueMutex;
+	bool _queueEvents;
+	bool _playingEvents;
+	bool _inTimerProc;
+	uint32 _timerProcTime;
+
+	struct QueuedEvent {
+		uint32 time;
+		uint32 msg;
+		byte *sysExData;
+		uint16 sysExLength;
+	};
+
+	// Sorted by time, events with the same time in the order they were sent
+	typedef Common::List<QueuedEvent> EventQueue;
+	EventQueue _eventQueue;
+
+	static void renderAheadTimer(void *refCon);
+
+	void renderAhead();
+	void renderSamples(int16 *data, int numSamples);
+	void runTimerProc();
+	bool queueEvent(uint32 msg, const byte *sysExData, uint16 sysExLength);
+	int32 samplesUntilNextEvent();
+	void playDueEvents();
+	void clearEventQueue();
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Render up to the given number of milliseconds of output ahead of
+	 * the mixer, from a timer callback instead of the mixer callback.
+	 * Every timer tick renders at most one block, so other timer
+	 * callbacks are never held up for long.
+	 *
+	 * The player timer callback is invoked from the rendering code, so
+	 * tempo stays sample accurate. All events have to go through
+	 * queueMessage() / queueSysEx(), so only the rendering code touches
+	 * the synth. Events sent from the player timer callback are played
+	 * right after it returns; those sent from anywhere else are played
+	 * exactly one buffer length after the mixer position they were sent at.
+	 *
+	 * Has to be called after open() but before the stream is handed to
+	 * the mixer, and with 0 in close() before the synth is torn down.
+	 *
+	 * @param ms	how far to render ahead, 0 disables render-ahead
+	 */
+	void setRenderAhead(uint ms);
+
+	/**
+	 * To be called first thing in send(). Returns true if the message was
+	 * queued for later and must not be played now. Once the queued message
+	 * is due, send() is called again from the rendering code and this
+	 * returns false.
+	 */
+	bool queueMessage(uint32 b) { return queueEvent(b, 0, 0); }
+
+	/** The sysEx() counterpart of queueMessage(). */
+	bool queueSysEx(const byte *msg, uint16 length) { return queueEvent(0, msg, length); }
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -58,9 +138,25 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_renderBuffer(0),
+		_renderBufferSize(0),
+		_renderReadPos(0),
+		_renderFill(0),
+		_underruns(0),
+		_underrunSamples(0),
+		_playedSamples(0),
+		_renderedSamples(0),
+		_queueEvents(false),
+		_playingEvents(false),
+		_inTimerProc(false),
+		_timerProcTime(0),
 		_baseFreq(250) {
 	}
 
+	virtual ~MidiDriver_Emulated() {
+		setRenderAhead(0);
+	}
+
 	// MidiDriver API
 	virtual int open() {
 		_isOpen = true;
@@ -87,35 +183,21 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
-	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
+	/** Number of mixer callbacks the render-ahead buffer could not satisfy. */
+	uint32 getUnderrunCount() const { return _underruns; }
 
-			generateSamples(data, step);
+	/**
+	 * Render the given amount of samples (per channel) as fast as possible
+	 * and throw them away, for benchmarking. The timer callback is run just
+	 * like during playback, so a MidiParser attached to it keeps playing.
+	 * The mixer stream of the driver is paused in the meantime.
+	 *
+	 * @return the time spent rendering, in milliseconds
+	 */
+	uint32 renderBenchmark(uint32 numSamples);
 
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
-
-				onTimer();
-
-				_nextTick += _samplesPerTick;
-			}
-
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	// AudioStream API
+	virtual int readBuffer(int16 *data, const int numSamples);
 
 	virtual bool endOfData() const {
 		return false;
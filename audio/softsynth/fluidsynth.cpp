@@ -145,6 +145,8 @@ int MidiDriver_FluidSynth::open() {
 
 	MidiDriver_Emulated::open();
 
+	setRenderAhead(ConfMan.getInt("midi_render_ahead"));
+
 	// The MT-32 emulator uses kSFXSoundType here. I don't know why.
 	_mixer->playStream(Audio::Mixer::kMusicSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 	return 0;
@@ -155,6 +157,7 @@ void MidiDriver_FluidSynth::close() {
 		return;
 	_isOpen = false;
 
+	setRenderAhead(0);
 	_mixer->stopHandle(_mixerSoundHandle);
 
 	if (_soundFont != -1)
@@ -165,6 +168,9 @@ void MidiDriver_FluidSynth::close() {
 }
 
 void MidiDriver_FluidSynth::send(uint32 b) {
+	if (queueMessage(b))
+		return;
+
 	//byte param3 = (byte) ((b >> 24) & 0xFF);
 	uint param2 = (byte) ((b >> 16) & 0xFF);
 	uint param1 = (byte) ((b >>  8) & 0xFF);
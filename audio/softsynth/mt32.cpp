@@ -338,12 +338,16 @@ int MidiDriver_MT32::open() {
 
 	g_system->updateScreen();
 
+	setRenderAhead(ConfMan.getInt("midi_render_ahead"));
+
 	_mixer->playStream(Audio::Mixer::kSFXSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
 }
 
 void MidiDriver_MT32::send(uint32 b) {
+	if (queueMessage(b))
+		return;
 	_synth->playMsg(b);
 }
 
@@ -365,6 +369,9 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
+	if (queueSysEx(msg, length))
+		return;
+
 	if (msg[0] == 0xf0) {
 		_synth->playSysex(msg, length);
 	} else {
@@ -379,6 +386,8 @@ void MidiDriver_MT32::close() {
 
 	// Detach the player callback handler
 	setTimerCallback(NULL, NULL);
+	// Stop rendering ahead before the synth goes away
+	setRenderAhead(0);
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
 
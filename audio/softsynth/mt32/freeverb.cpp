@@ -29,7 +29,11 @@
 // http://www.dreampoint.co.uk
 // This code is public domain
 
-#include "audio/softsynth/mt32/freeverb.h"
+#include "audio/softsynth/mt32/mt32emu.h"
+
+#if MT32EMU_USE_SIMD > 0
+#include <emmintrin.h>
+#endif
 
 comb::comb() {
 	filterstore = 0;
@@ -153,6 +157,60 @@ void revmodel::mute() {
 	}
 }
 
+// Feeds one sample through all comb filters and accumulates their output.
+// With SIMD the filter arithmetic of all combs is done at once, the
+// outputs are still summed up in the original order.
+inline void revmodel::processcombs(float input, float &outL, float &outR) {
+#if MT32EMU_USE_SIMD > 0
+	float output[numcombs * 2];
+	float store[numcombs * 2];
+	float feed[numcombs * 2];
+	int i;
+
+	for (i = 0; i < numcombs; i++) {
+		output[i] = combL[i].buffer[combL[i].bufidx];
+		output[numcombs + i] = combR[i].buffer[combR[i].bufidx];
+		store[i] = combL[i].filterstore;
+		store[numcombs + i] = combR[i].filterstore;
+	}
+
+	// All combs share the same damping and feedback, see update()
+	const __m128 combDamp1 = _mm_set1_ps(combL[0].damp1);
+	const __m128 combDamp2 = _mm_set1_ps(combL[0].damp2);
+	const __m128 combFeedback = _mm_set1_ps(combL[0].feedback);
+	const __m128 in = _mm_set1_ps(input);
+
+	for (i = 0; i < numcombs * 2; i += 4) {
+		__m128 fs = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(output + i), combDamp2), _mm_mul_ps(_mm_loadu_ps(store + i), combDamp1));
+		_mm_storeu_ps(store + i, fs);
+		_mm_storeu_ps(feed + i, _mm_add_ps(in, _mm_mul_ps(fs, combFeedback)));
+	}
+
+	for (i = 0; i < numcombs; i++) {
+		comb &l = combL[i];
+		comb &r = combR[i];
+
+		l.filterstore = store[i];
+		l.buffer[l.bufidx] = feed[i];
+		if (++l.bufidx >= l.bufsize)
+			l.bufidx = 0;
+
+		r.filterstore = store[numcombs + i];
+		r.buffer[r.bufidx] = feed[numcombs + i];
+		if (++r.bufidx >= r.bufsize)
+			r.bufidx = 0;
+
+		outL += output[i];
+		outR += output[numcombs + i];
+	}
+#else
+	for (int i = 0; i < numcombs; i++) {
+		outL += combL[i].process(input);
+		outR += combR[i].process(input);
+	}
+#endif
+}
+
 void revmodel::processreplace(float *inputL, float *inputR, float *outputL, float *outputR, long numsamples, int skip) {
 	float outL, outR, input;
 
@@ -163,10 +221,7 @@ void revmodel::processreplace(float *inputL, float *inputR, float *outputL, floa
 		input = (*inputL + *inputR) * gain;
 
 		// Accumulate comb filters in parallel
-		for (i = 0; i < numcombs; i++) {
-			outL += combL[i].process(input);
-			outR += combR[i].process(input);
-		}
+		processcombs(input, outL, outR);
 
 		// Feed through allpasses in series
 		for (i = 0; i < numallpasses; i++) {
@@ -196,10 +251,7 @@ void revmodel::processmix(float *inputL, float *inputR, float *outputL, float *o
 		input = (*inputL + *inputR) * gain;
 
 		// Accumulate comb filters in parallel
-		for (i = 0; i < numcombs; i++) {
-			outL += combL[i].process(input);
-			outR += combR[i].process(input);
-		}
+		processcombs(input, outL, outR);
 
 		// Feed through allpasses in series
 		for (i = 0; i < numallpasses; i++) {
@@ -53,6 +53,8 @@ public:
 	void setfeedback(float val);
 	float getfeedback();
 private:
+	friend class revmodel;
+
 	float feedback;
 	float filterstore;
 	float damp1;
@@ -191,6 +193,7 @@ public:
 	float getmode();
 private:
 	void update();
+	inline void processcombs(float input, float &outL, float &outR);
 
 	float gain;
 	float roomsize, roomsize1;
@@ -3,6 +3,7 @@ MODULE := audio/softsynth/mt32
 MODULE_OBJS := \
 	mt32_file.o \
 	i386.o \
+	simd.o \
 	part.o \
 	partial.o \
 	partialManager.o \
@@ -56,10 +56,22 @@
 #define MT32EMU_USE_MMX 0
 #endif
 
+// SSE2 intrinsics, used wherever the inline assembly above isn't
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MT32EMU_HAVE_SSE2
+#endif
+
+#if defined(MT32EMU_HAVE_SSE2) && MT32EMU_USE_MMX == 0
+#define MT32EMU_USE_SIMD 1
+#else
+#define MT32EMU_USE_SIMD 0
+#endif
+
 #include "freeverb.h"
 
 #include "structures.h"
 #include "i386.h"
+#include "simd.h"
 #include "mt32_file.h"
 #include "tables.h"
 #include "partial.h"
@@ -468,6 +468,11 @@ Bit16s *Partial::mixBuffers(Bit16s * buf1, Bit16s *buf2, int len) {
 	len -= donelen;
 	buf1 += donelen;
 	buf2 += donelen;
+#elif MT32EMU_USE_SIMD > 0
+	int donelen = simd_mixBuffers(buf1, buf2, len);
+	len -= donelen;
+	buf1 += donelen;
+	buf2 += donelen;
 #endif
 	while (len--) {
 		*buf1 = *buf1 + *buf2;
@@ -498,6 +503,11 @@ Bit16s *Partial::mixBuffersRingMix(Bit16s * buf1, Bit16s *buf2, int len) {
 	len -= donelen;
 	buf1 += donelen;
 	buf2 += donelen;
+#elif MT32EMU_USE_SIMD > 0
+	int donelen = simd_mixBuffersRingMix(buf1, buf2, len);
+	len -= donelen;
+	buf1 += donelen;
+	buf2 += donelen;
 #endif
 	while (len--) {
 		float a, b;
@@ -531,6 +541,11 @@ Bit16s *Partial::mixBuffersRing(Bit16s * buf1, Bit16s *buf2, int len) {
 	len -= donelen;
 	buf1 += donelen;
 	buf2 += donelen;
+#elif MT32EMU_USE_SIMD > 0
+	int donelen = simd_mixBuffersRing(buf1, buf2, len);
+	len -= donelen;
+	buf1 += donelen;
+	buf2 += donelen;
 #endif
 	while (len--) {
 		float a, b;
@@ -560,6 +575,13 @@ void Partial::mixBuffersStereo(Bit16s *buf1, Bit16s *buf2, Bit16s *outBuf, int l
 			*outBuf++ = *buf2++;
 		}
 	} else {
+#if MT32EMU_USE_SIMD > 0
+		int donelen = simd_mixBuffersStereo(buf1, buf2, outBuf, len);
+		len -= donelen;
+		buf1 += donelen;
+		buf2 += donelen;
+		outBuf += donelen * 2;
+#endif
 		while (len--) {
 			*outBuf++ = *buf1++;
 			*outBuf++ = *buf2++;
@@ -645,6 +667,11 @@ bool Partial::produceOutput(Bit16s *partialBuf, long length) {
 	length -= donelen;
 	mixedBuf += donelen;
 	partialBuf += donelen * 2;
+#elif MT32EMU_USE_SIMD > 0
+	int donelen = simd_partialProductOutput(length, leftvol, rightvol, partialBuf, mixedBuf);
+	length -= donelen;
+	mixedBuf += donelen;
+	partialBuf += donelen * 2;
 #endif
 	while (length--) {
 		*partialBuf++ = (Bit16s)(((Bit32s)*mixedBuf * (Bit32s)leftvol) >> 15);
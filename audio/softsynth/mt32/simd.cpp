@@ -0,0 +1,166 @@
+/* Copyright (c) 2003-2005 Various contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "mt32emu.h"
+
+#if MT32EMU_USE_SIMD > 0
+
+#include <emmintrin.h>
+
+namespace MT32Emu {
+
+// (a * b) >> 15, cut down to 16 bits the way the C code does
+static inline __m128i mulShift15(__m128i a, __m128i b) {
+	__m128i lo = _mm_mullo_epi16(a, b);
+	__m128i hi = _mm_mulhi_epi16(a, b);
+	return _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+}
+
+static inline __m128 unpackLoToFloat(__m128i v) {
+	return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+static inline __m128 unpackHiToFloat(__m128i v) {
+	return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+static inline __m128 ringMix(__m128 a, __m128 b, bool withSource) {
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+
+	__m128 r = _mm_mul_ps(a, b);
+	if (withSource)
+		r = _mm_add_ps(r, a);
+	return _mm_max_ps(_mm_min_ps(r, one), minusOne);
+}
+
+static int mixRing(Bit16s *buf1, Bit16s *buf2, int len, bool withSource) {
+	// Scaling by a power of two is exact, so multiplying by the
+	// reciprocal matches the division in the C code.
+	const __m128 scale = _mm_set1_ps(1.0f / 8192.0f);
+	const __m128 unscale = _mm_set1_ps(8192.0f);
+	const int done = len & ~7;
+
+	for (int i = 0; i < done; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(buf1 + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(buf2 + i));
+
+		__m128 lo = ringMix(_mm_mul_ps(unpackLoToFloat(a), scale), _mm_mul_ps(unpackLoToFloat(b), scale), withSource);
+		__m128 hi = ringMix(_mm_mul_ps(unpackHiToFloat(a), scale), _mm_mul_ps(unpackHiToFloat(b), scale), withSource);
+
+		__m128i out = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(lo, unscale)), _mm_cvttps_epi32(_mm_mul_ps(hi, unscale)));
+		_mm_storeu_si128((__m128i *)(buf1 + i), out);
+	}
+	return done;
+}
+
+int simd_partialProductOutput(int len, Bit16s leftvol, Bit16s rightvol, Bit16s *partialBuf, Bit16s *mixedBuf) {
+	const __m128i left = _mm_set1_epi16(leftvol);
+	const __m128i right = _mm_set1_epi16(rightvol);
+	const int done = len & ~7;
+
+	for (int i = 0; i < done; i += 8) {
+		__m128i m = _mm_loadu_si128((const __m128i *)(mixedBuf + i));
+		__m128i l = mulShift15(m, left);
+		__m128i r = mulShift15(m, right);
+		_mm_storeu_si128((__m128i *)(partialBuf + i * 2), _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128((__m128i *)(partialBuf + i * 2 + 8), _mm_unpackhi_epi16(l, r));
+	}
+	return done;
+}
+
+int simd_mixBuffers(Bit16s *buf1, Bit16s *buf2, int len) {
+	const int done = len & ~7;
+
+	for (int i = 0; i < done; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(buf1 + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(buf2 + i));
+		_mm_storeu_si128((__m128i *)(buf1 + i), _mm_add_epi16(a, b));
+	}
+	return done;
+}
+
+int simd_mixBuffersRingMix(Bit16s *buf1, Bit16s *buf2, int len) {
+	return mixRing(buf1, buf2, len, true);
+}
+
+int simd_mixBuffersRing(Bit16s *buf1, Bit16s *buf2, int len) {
+	return mixRing(buf1, buf2, len, false);
+}
+
+int simd_mixBuffersStereo(Bit16s *buf1, Bit16s *buf2, Bit16s *outBuf, int len) {
+	const int done = len & ~7;
+
+	for (int i = 0; i < done; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(buf1 + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(buf2 + i));
+		_mm_storeu_si128((__m128i *)(outBuf + i * 2), _mm_unpacklo_epi16(a, b));
+		_mm_storeu_si128((__m128i *)(outBuf + i * 2 + 8), _mm_unpackhi_epi16(a, b));
+	}
+	return done;
+}
+
+int simd_produceOutput1(Bit16s *useBuf, Bit16s *stream, Bit32u len, Bit16s volume) {
+	const __m128i vol = _mm_set1_epi16(volume);
+	const int done = len & ~3;
+
+	for (int i = 0; i < done * 2; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(stream + i));
+		__m128i u = _mm_loadu_si128((const __m128i *)(useBuf + i));
+		_mm_storeu_si128((__m128i *)(stream + i), _mm_add_epi16(s, mulShift15(u, vol)));
+	}
+	return done;
+}
+
+int simd_streamToFloat(const Bit16s *stream, float *bufl, float *bufr, Bit32u len) {
+	const __m128 div = _mm_set1_ps(32767.0f);
+	const int done = len & ~3;
+
+	for (int i = 0; i < done; i += 4) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(stream + i * 2));
+		__m128 lo = _mm_div_ps(unpackLoToFloat(s), div);
+		__m128 hi = _mm_div_ps(unpackHiToFloat(s), div);
+		_mm_storeu_ps(bufl + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(bufr + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+	return done;
+}
+
+int simd_floatToStream(const float *bufl, const float *bufr, Bit16s *stream, Bit32u len) {
+	const __m128 mul = _mm_set1_ps(32767.0f);
+	const int done = len & ~3;
+
+	for (int i = 0; i < done; i += 4) {
+		__m128i l = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(bufl + i), mul));
+		__m128i r = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(bufr + i), mul));
+		__m128i lo = _mm_unpacklo_epi32(l, r);
+		__m128i hi = _mm_unpackhi_epi32(l, r);
+		// Keep the low 16 bits like the C cast does, instead of saturating
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i *)(stream + i * 2), _mm_packs_epi32(lo, hi));
+	}
+	return done;
+}
+
+}
+
+#endif
@@ -84,6 +84,9 @@ namespace DBOPL {
 #define ENV_LIMIT	( ( 12 * 256) >> ( 3 - ENV_EXTRA ) )
 #define ENV_SILENT( _X_ ) ( (_X_) >= ENV_LIMIT )
 
+//Amount of samples the envelope generators are run ahead for
+#define BLOCK_SIZE	64
+
 //Attack/decay/release rate counter shift
 #define RATE_SH		24
 #define RATE_MASK	( ( 1 << RATE_SH ) - 1 )
@@ -595,6 +598,58 @@ INLINE Bits Operator::GetSample( Bits modulation ) {
 	}
 }
 
+/*
+	Block generation, run the envelope generator of an operator for a couple
+	of samples at once, so the sample loop only has to do the waves. The
+	envelope only depends on the operator itself, so this gives the very same
+	result as GetSample.
+*/
+
+template< Operator::State yes>
+Bitu Operator::TemplateEnvelope( Bitu i, Bitu samples, Bit32u* vol ) {
+	while ( i < samples && state == yes ) {
+		vol[ i++ ] = currentLevel + TemplateVolume< yes >();
+	}
+	return i;
+}
+
+void Operator::GenerateEnvelope( Bitu samples, Bit32u* vol ) {
+	Bitu i = 0;
+	while ( i < samples ) {
+		switch ( state ) {
+		case OFF:
+			for ( ; i < samples; i++ )
+				vol[ i ] = currentLevel + ENV_MAX;
+			break;
+		case RELEASE:
+			i = TemplateEnvelope< RELEASE >( i, samples, vol );
+			break;
+		case SUSTAIN:
+			if ( reg20 & MASK_SUSTAIN ) {
+				//Held, the volume doesn't change until a register write
+				for ( ; i < samples; i++ )
+					vol[ i ] = currentLevel + volume;
+			} else {
+				i = TemplateEnvelope< SUSTAIN >( i, samples, vol );
+			}
+			break;
+		case DECAY:
+			i = TemplateEnvelope< DECAY >( i, samples, vol );
+			break;
+		case ATTACK:
+			i = TemplateEnvelope< ATTACK >( i, samples, vol );
+			break;
+		}
+	}
+}
+
+INLINE Bits Operator::GetBlockSample( Bit32u vol, Bit32u& index, Bit32u add, Bits modulation ) {
+	index += add;
+	if ( ENV_SILENT( vol ) )
+		return 0;
+	return GetWave( ( index >> WAVE_SH ) + modulation, vol );
+}
+
 Operator::Operator() {
 	chanData = 0;
 	freqMul = 0;
@@ -911,81 +966,110 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 		Op( 4 )->Prepare( chip );
 		Op( 5 )->Prepare( chip );
 	}
-	for ( Bitu i = 0; i < samples; i++ ) {
-		//Early out for percussion handlers
-		if ( mode == sm2Percussion ) {
-			GeneratePercussion<false>( chip, output + i );
-			continue;	//Prevent some unitialized value bitching
-		} else if ( mode == sm3Percussion ) {
-			GeneratePercussion<true>( chip, output + i * 2 );
-			continue;	//Prevent some unitialized value bitching
+	//Percussion uses the operators of three channels, leave it to the per sample code
+	if ( mode == sm2Percussion || mode == sm3Percussion ) {
+		for ( Bitu i = 0; i < samples; i++ ) {
+			if ( mode == sm2Percussion ) {
+				GeneratePercussion<false>( chip, output + i );
+			} else {
+				GeneratePercussion<true>( chip, output + i * 2 );
+			}
 		}
-
-		//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
-		Bit32s mod = (Bit32u)((old[0] + old[1])) >> feedback;
-		old[0] = old[1];
-		old[1] = Op(0)->GetSample( mod );
-		Bit32s sample;
-		Bit32s out0 = old[0];
-		if ( mode == sm2AM || mode == sm3AM ) {
-			sample = out0 + Op(1)->GetSample( 0 );
-		} else if ( mode == sm2FM || mode == sm3FM ) {
-			sample = Op(1)->GetSample( out0 );
-		} else if ( mode == sm3FMFM ) {
-			Bits next = Op(1)->GetSample( out0 );
-			next = Op(2)->GetSample( next );
-			sample = Op(3)->GetSample( next );
-		} else if ( mode == sm3AMFM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 );
-			next = Op(2)->GetSample( next );
-			sample += Op(3)->GetSample( next );
-		} else if ( mode == sm3FMAM ) {
-			sample = Op(1)->GetSample( out0 );
-			Bits next = Op(2)->GetSample( 0 );
-			sample += Op(3)->GetSample( next );
-		} else if ( mode == sm3AMAM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 );
-			sample += Op(2)->GetSample( next );
-			sample += Op(3)->GetSample( 0 );
+		return( this + 3 );
+	}
+	//Run the envelopes ahead for a block, and keep the feedback and the
+	//wave counters in locals, so the sample loop only generates the waves
+	const Bitu opCount = ( mode > sm4Start ) ? 4 : 2;
+	Bit32u vol[ 4 ][ BLOCK_SIZE ];
+	Bit32u waveIndex[ 4 ];
+	Bit32u waveCurrent[ 4 ];
+	Bit32s old0 = old[0];
+	Bit32s old1 = old[1];
+	for ( Bitu o = 0; o < opCount; o++ ) {
+		waveIndex[ o ] = Op( o )->waveIndex;
+		waveCurrent[ o ] = Op( o )->waveCurrent;
+	}
+	for ( Bitu block = 0; block < samples; block += BLOCK_SIZE ) {
+		const Bitu todo = ( samples - block < BLOCK_SIZE ) ? ( samples - block ) : BLOCK_SIZE;
+		for ( Bitu o = 0; o < opCount; o++ ) {
+			Op( o )->GenerateEnvelope( todo, vol[ o ] );
 		}
-		switch( mode ) {
-		case sm2AM:
-		case sm2FM:
-			output[ i ] += sample;
-			break;
-		case sm3AM:
-		case sm3FM:
-		case sm3FMFM:
-		case sm3AMFM:
-		case sm3FMAM:
-		case sm3AMAM:
-			output[ i * 2 + 0 ] += sample & maskLeft;
-			output[ i * 2 + 1 ] += sample & maskRight;
-			break;
-		case sm2Percussion:
-			// This case was not handled in the DOSBox code either
-			// thus we leave this blank.
-			// TODO: Consider checking this.
-			break;
-		case sm3Percussion:
-			// This case was not handled in the DOSBox code either
-			// thus we leave this blank.
-			// TODO: Consider checking this.
-			break;
-		case sm4Start:
-			// This case was not handled in the DOSBox code either
-			// thus we leave this blank.
-			// TODO: Consider checking this.
-			break;
-		case sm6Start:
-			// This case was not handled in the DOSBox code either
-			// thus we leave this blank.
-			// TODO: Consider checking this.
-			break;
+#define OP_SAMPLE( _OP_, _MOD_ ) Op( _OP_ )->GetBlockSample( vol[ _OP_ ][ j ], waveIndex[ _OP_ ], waveCurrent[ _OP_ ], _MOD_ )
+		for ( Bitu j = 0; j < todo; j++ ) {
+			const Bitu i = block + j;
+
+			//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
+			Bit32s mod = (Bit32u)((old0 + old1)) >> feedback;
+			old0 = old1;
+			old1 = OP_SAMPLE( 0, mod );
+			Bit32s sample;
+			Bit32s out0 = old0;
+			if ( mode == sm2AM || mode == sm3AM ) {
+				sample = out0 + OP_SAMPLE( 1, 0 );
+			} else if ( mode == sm2FM || mode == sm3FM ) {
+				sample = OP_SAMPLE( 1, out0 );
+			} else if ( mode == sm3FMFM ) {
+				Bits next = OP_SAMPLE( 1, out0 );
+				next = OP_SAMPLE( 2, next );
+				sample = OP_SAMPLE( 3, next );
+			} else if ( mode == sm3AMFM ) {
+				sample = out0;
+				Bits next = OP_SAMPLE( 1, 0 );
+				next = OP_SAMPLE( 2, next );
+				sample += OP_SAMPLE( 3, next );
+			} else if ( mode == sm3FMAM ) {
+				sample = OP_SAMPLE( 1, out0 );
+				Bits next = OP_SAMPLE( 2, 0 );
+				sample += OP_SAMPLE( 3, next );
+			} else if ( mode == sm3AMAM ) {
+				sample = out0;
+				Bits next = OP_SAMPLE( 1, 0 );
+				sample += OP_SAMPLE( 2, next );
+				sample += OP_SAMPLE( 3, 0 );
+			}
+			switch( mode ) {
+			case sm2AM:
+			case sm2FM:
+				output[ i ] += sample;
+				break;
+			case sm3AM:
+			case sm3FM:
+			case sm3FMFM:
+			case sm3AMFM:
+			case sm3FMAM:
+			case sm3AMAM:
+				output[ i * 2 + 0 ] += sample & maskLeft;
+				output[ i * 2 + 1 ] += sample & maskRight;
+				break;
+			case sm2Percussion:
+				// This case was not handled in the DOSBox code either
+				// thus we leave this blank.
+				// TODO: Consider checking this.
+				break;
+			case sm3Percussion:
+				// This case was not handled in the DOSBox code either
+				// thus we leave this blank.
+				// TODO: Consider checking this.
+				break;
+			case sm4Start:
+				// This case was not handled in the DOSBox code either
+				// thus we leave this blank.
+				// TODO: Consider checking this.
+				break;
+			case sm6Start:
+				// This case was not handled in the DOSBox code either
+				// thus we leave this blank.
+				// TODO: Consider checking this.
+				break;
+			}
 		}
 	}
+#undef OP_SAMPLE
+	old[0] = old0;
+	old[1] = old1;
+	for ( Bitu o = 0; o < opCount; o++ ) {
+		Op( o )->waveIndex = waveIndex[ o ];
+	}
 	switch( mode ) {
 	case sm2AM:
 	case sm2FM:
@@ -178,6 +178,12 @@ public:
 
 	Bits GetSample( Bits modulation );
 	Bits GetWave( Bitu index, Bitu vol );
+
+	//Run the envelope generator ahead for a block of samples
+	template< State state>
+	Bitu TemplateEnvelope( Bitu i, Bitu samples, Bit32u* vol );
+	void GenerateEnvelope( Bitu samples, Bit32u* vol );
+	Bits GetBlockSample( Bit32u vol, Bit32u& index, Bit32u add, Bits modulation );
 public:
 	Operator();
 };
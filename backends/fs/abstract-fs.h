@@ -161,6 +161,14 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Returns the time of the last modification of the object referred by
+	 * this path, in seconds since an epoch defined by the file system.
+	 *
+	 * @note By default, this method returns 0, meaning the time is unknown.
+	 */
+	virtual uint32 getLastModified() const { return 0; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -92,6 +92,14 @@ POSIXFilesystemNode::POSIXFilesystemNode(const Common::String &p) {
 	setFlags();
 }
 
+uint32 POSIXFilesystemNode::getLastModified() const {
+	struct stat st;
+
+	if (stat(_path.c_str(), &st) != 0)
+		return 0;
+	return (uint32)st.st_mtime;
+}
+
 AbstractFSNode *POSIXFilesystemNode::getChild(const Common::String &n) const {
 	assert(!_path.empty());
 	assert(_isDirectory);
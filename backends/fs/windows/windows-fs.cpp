@@ -97,6 +97,7 @@ public:
 	virtual bool isDirectory() const { return _isDirectory; }
 	virtual bool isReadable() const { return _access(_path.c_str(), R_OK) == 0; }
 	virtual bool isWritable() const { return _access(_path.c_str(), W_OK) == 0; }
+	virtual uint32 getLastModified() const;
 
 	virtual AbstractFSNode *getChild(const Common::String &n) const;
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const;
@@ -226,6 +227,20 @@ WindowsFilesystemNode::WindowsFilesystemNode(const Common::String &p, const bool
 	_isPseudoRoot = false;
 }
 
+uint32 WindowsFilesystemNode::getLastModified() const {
+	WIN32_FILE_ATTRIBUTE_DATA data;
+
+	if (!GetFileAttributesEx(toUnicode(_path.c_str()), GetFileExInfoStandard, &data))
+		return 0;
+
+	// FILETIME counts 100 ns intervals since 1601; the seconds are truncated
+	// to 32 bits, which still changes whenever the file is written
+	ULARGE_INTEGER time;
+	time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+	time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+	return (uint32)(time.QuadPart / 10000000);
+}
+
 AbstractFSNode *WindowsFilesystemNode::getChild(const Common::String &n) const {
 	assert(_isDirectory);
 
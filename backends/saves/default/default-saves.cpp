@@ -81,8 +81,15 @@ Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &
 }
 
 Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String &filename) {
+	return openForLoadingFrom(getSavePath(), filename);
+}
+
+Common::InSaveFile *DefaultSaveFileManager::openGlobalForLoading(const Common::String &filename) {
+	return openForLoadingFrom(getGlobalSavePath(), filename);
+}
+
+Common::InSaveFile *DefaultSaveFileManager::openForLoadingFrom(const Common::String &savePathName, const Common::String &filename) {
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
-	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError().getCode() != Common::kNoError)
 		return 0;
@@ -101,8 +108,15 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 }
 
 Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String &filename) {
+	return openForSavingTo(getSavePath(), filename);
+}
+
+Common::OutSaveFile *DefaultSaveFileManager::openGlobalForSaving(const Common::String &filename) {
+	return openForSavingTo(getGlobalSavePath(), filename);
+}
+
+Common::OutSaveFile *DefaultSaveFileManager::openForSavingTo(const Common::String &savePathName, const Common::String &filename) {
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
-	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError().getCode() != Common::kNoError)
 		return 0;
@@ -169,4 +183,20 @@ Common::String DefaultSaveFileManager::getSavePath() const {
 	return dir;
 }
 
+Common::String DefaultSaveFileManager::getGlobalSavePath() const {
+	// A save path given on the command line applies to all games
+	const Common::ConfigManager::Domain *transient = ConfMan.getDomain(Common::ConfigManager::kTransientDomain);
+	if (transient && transient->contains("savepath"))
+		return transient->getVal("savepath");
+
+	Common::String dir = ConfMan.get("savepath", Common::ConfigManager::kApplicationDomain);
+
+#ifdef _WIN32_WCE
+	if (dir.empty())
+		dir = ConfMan.get("path", Common::ConfigManager::kApplicationDomain);
+#endif
+
+	return dir;
+}
+
 #endif // !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
@@ -42,6 +42,8 @@ public:
 	virtual Common::StringArray listSavefiles(const Common::String &pattern);
 	virtual Common::InSaveFile *openForLoading(const Common::String &filename);
 	virtual Common::OutSaveFile *openForSaving(const Common::String &filename);
+	virtual Common::InSaveFile *openGlobalForLoading(const Common::String &filename);
+	virtual Common::OutSaveFile *openGlobalForSaving(const Common::String &filename);
 	virtual bool removeSavefile(const Common::String &filename);
 
 protected:
@@ -52,6 +54,15 @@ protected:
 	 */
 	virtual Common::String getSavePath() const;
 
+	/**
+	 * Get the path to the savegame directory of the application. Unlike
+	 * getSavePath(), this ignores the save path of the running game.
+	 */
+	virtual Common::String getGlobalSavePath() const;
+
+	Common::InSaveFile *openForLoadingFrom(const Common::String &savePathName, const Common::String &filename);
+	Common::OutSaveFile *openForSavingTo(const Common::String &savePathName, const Common::String &filename);
+
 	/**
 	 * Checks the given path for read access, existence, etc.
 	 * Sets the internal error and error message accordingly.
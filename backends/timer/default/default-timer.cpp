@@ -150,3 +150,19 @@ void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 		}
 	}
 }
+
+void DefaultTimerManager::removeTimerProc(TimerProc callback, void *refCon) {
+	Common::StackLock lock(_mutex);
+
+	TimerSlot *slot = _head;
+
+	while (slot->next) {
+		if (slot->next->callback == callback && slot->next->refCon == refCon) {
+			TimerSlot *next = slot->next->next;
+			delete slot->next;
+			slot->next = next;
+		} else {
+			slot = slot->next;
+		}
+	}
+}
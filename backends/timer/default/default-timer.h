@@ -41,6 +41,7 @@ public:
 	virtual ~DefaultTimerManager();
 	virtual bool installTimerProc(TimerProc proc, int32 interval, void *refCon);
 	virtual void removeTimerProc(TimerProc proc);
+	virtual void removeTimerProc(TimerProc proc, void *refCon);
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
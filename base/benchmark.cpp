@@ -0,0 +1,637 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+#include "base/benchmark.h"
+
+#include "common/file.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/unzip.h"
+
+#include "audio/fmopl.h"
+#include "audio/midiparser.h"
+#include "audio/mixer_intern.h"
+#include "audio/musicplugin.h"
+#include "audio/softsynth/emumidi.h"
+#include "audio/softsynth/opl/dbopl.h"
+
+#include "graphics/conversion.h"
+#include "graphics/jpeg.h"
+#include "graphics/VectorRenderer.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "gui/debugger.h"
+#include "gui/ThemeEngine.h"
+
+#include "video/smk_decoder.h"
+
+namespace Base {
+
+/** Measures the time spent in the code under test, in milliseconds. */
+class Stopwatch {
+public:
+	Stopwatch() { restart(); }
+
+	void restart() { _start = g_system->getMillis(); }
+	uint32 elapsed() const { return g_system->getMillis() - _start; }
+
+private:
+	uint32 _start;
+};
+
+/**
+ * Print the amount processed per second with the given format, unless the
+ * measured time is too short to tell.
+ */
+static void printRate(GUI::Debugger *con, const char *format, float amount, uint32 millis) {
+	if (millis)
+		con->DebugPrintf(format, amount * 1000.0f / millis);
+}
+
+/** The screen format, or RGB565 for paletted screens. */
+static Graphics::PixelFormat getTrueColorFormat() {
+	Graphics::PixelFormat format = g_system->getScreenFormat();
+	if (format.bytesPerPixel == 1)
+		format = Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+	return format;
+}
+
+/** Read a whole file into a new buffer, or print an error. */
+static byte *readFile(GUI::Debugger *con, const char *filename, uint32 &size) {
+	Common::File file;
+	if (!file.open(filename)) {
+		con->DebugPrintf("Could not open '%s'\n", filename);
+		return 0;
+	}
+
+	size = file.size();
+	byte *data = new byte[size];
+	file.read(data, size);
+	return data;
+}
+
+// The software synths rendering through MidiDriver_Emulated, by plugin id
+// and the type of their device
+static const struct {
+	const char *id;
+	MusicType type;
+} emulatedDrivers[] = {
+	{ "mt32", MT_MT32 },
+	{ "fluidsynth", MT_GM },
+	{ "adlib", MT_ADLIB },
+	{ "towns", MT_TOWNS }
+};
+
+/**
+ * Find the device of the given software synth. Returns 0 unless driverId
+ * names one of the emulatedDrivers, and its plugin is available.
+ */
+static MidiDriver::DeviceHandle findEmulatedDevice(const char *driverId, MusicType &type) {
+	type = MT_INVALID;
+	for (int i = 0; i < ARRAYSIZE(emulatedDrivers); ++i) {
+		if (!strcmp(driverId, emulatedDrivers[i].id))
+			type = emulatedDrivers[i].type;
+	}
+
+	if (type == MT_INVALID)
+		return 0;
+
+	// MidiDriver::getMusicType() is no help here, as it reports MT_MT32
+	// for every device while a game forces MT-32 mode.
+	const MusicPlugin::List p = MusicMan.getPlugins();
+	for (MusicPlugin::List::const_iterator m = p.begin(); m != p.end(); ++m) {
+		if (strcmp((**m)->getId(), driverId))
+			continue;
+
+		MusicDevices devices = (**m)->getDevices();
+		for (MusicDevices::iterator d = devices.begin(); d != devices.end(); ++d) {
+			if (d->getMusicType() == type)
+				return d->getHandle();
+		}
+	}
+
+	return 0;
+}
+
+// Plays a MIDI file through one of the software synths as fast as possible
+static bool benchMidi(GUI::Debugger *con, int argc, const char **argv) {
+	if (argc < 2)
+		return false;
+
+	const char *driverId = (argc > 2) ? argv[2] : "mt32";
+	const uint32 maxSeconds = (argc > 3) ? atoi(argv[3]) : 60;
+
+	MusicType type;
+	MidiDriver::DeviceHandle dev = findEmulatedDevice(driverId, type);
+	if (!dev) {
+		con->DebugPrintf("'%s' is not an available software synth\n", driverId);
+		return true;
+	}
+
+	// Creating a second OPL emulator is a fatal error
+	if (type == MT_ADLIB && OPL::OPL::hasInstance()) {
+		con->DebugPrintf("The AdLib emulator is in use by the game, it can only be benchmarked from a game without AdLib music\n");
+		return true;
+	}
+
+	uint32 size;
+	byte *data = readFile(con, argv[1], size);
+	if (!data)
+		return true;
+
+	MidiDriver *midiDriver = MidiDriver::createMidi(dev);
+	if (!midiDriver) {
+		con->DebugPrintf("Could not create the '%s' driver\n", driverId);
+		delete[] data;
+		return true;
+	}
+
+	// All devices found by findEmulatedDevice() are MidiDriver_Emulated
+	MidiDriver_Emulated *driver = static_cast<MidiDriver_Emulated *>(midiDriver);
+
+	MidiParser *parser = MidiParser::createParser_SMF();
+
+	if (driver->open()) {
+		con->DebugPrintf("Could not open the '%s' driver\n", driverId);
+	} else if (!parser->loadMusic(data, size)) {
+		con->DebugPrintf("'%s' is not a standard MIDI file\n", argv[1]);
+		driver->close();
+	} else {
+		parser->setMidiDriver(driver);
+		parser->setTimerRate(driver->getBaseTempo());
+		driver->setTimerCallback(parser, MidiParser::timerCallback);
+
+		const uint32 rate = driver->getRate();
+		uint32 samples = 0;
+		uint32 millis = 0;
+		while (parser->isPlaying() && samples < maxSeconds * rate) {
+			millis += driver->renderBenchmark(rate / 10);
+			samples += rate / 10;
+		}
+
+		driver->setTimerCallback(0, 0);
+		parser->unloadMusic();
+		parser->setMidiDriver(0);
+		driver->close();
+
+		const float seconds = (float)samples / rate;
+		con->DebugPrintf("Rendered %.1f s of audio at %d Hz in %d ms", seconds, rate, millis);
+		printRate(con, ", %.2fx realtime", seconds, millis);
+		con->DebugPrintf("\n");
+	}
+
+	delete driver;
+	delete parser;
+	delete[] data;
+	return true;
+}
+
+#ifndef DISABLE_DOSBOX_OPL
+// Renders a synthetic tune through a number of DOSBox OPL chips
+static bool benchOPL(GUI::Debugger *con, int argc, const char **argv) {
+	using namespace OPL::DOSBox::DBOPL;
+
+	const int chips = (argc > 1) ? atoi(argv[1]) : 1;
+	const uint32 seconds = (argc > 2) ? atoi(argv[2]) : 10;
+	const bool opl3 = (argc > 3) && !strcmp(argv[3], "opl3");
+
+	if (chips < 1 || chips > 64 || !seconds)
+		return false;
+
+	static const uint16 notes[] = { 0x157, 0x181, 0x1B0, 0x1CA, 0x202, 0x241, 0x287, 0x2AE };
+	const uint32 rate = 49716;
+	const uint32 step = rate / 8;
+
+	InitTables();
+	Chip **chip = new Chip *[chips];
+	for (int c = 0; c < chips; ++c) {
+		chip[c] = new Chip();
+		chip[c]->Setup(rate);
+		chip[c]->WriteReg(0x01, 0x20);
+		if (opl3)
+			chip[c]->WriteReg(0x105, 1);
+
+		// A plucked FM voice on every channel, in both banks for OPL3
+		for (int bank = 0; bank < (opl3 ? 2 : 1); ++bank) {
+			for (int ch = 0; ch < 9; ++ch) {
+				const uint32 op = bank * 0x100 + (ch / 3) * 8 + (ch % 3);
+				chip[c]->WriteReg(op + 0x20, 0x21);
+				chip[c]->WriteReg(op + 0x23, 0x01);
+				chip[c]->WriteReg(op + 0x40, 0x18);
+				chip[c]->WriteReg(op + 0x43, 0x00);
+				chip[c]->WriteReg(op + 0x60, 0xF2);
+				chip[c]->WriteReg(op + 0x63, 0xF4);
+				chip[c]->WriteReg(op + 0x80, 0x57);
+				chip[c]->WriteReg(op + 0x83, 0x57);
+				chip[c]->WriteReg(op + 0xE0, ch % 4);
+				chip[c]->WriteReg(bank * 0x100 + 0xC0 + ch, 0x3E);
+			}
+		}
+	}
+
+	int32 *buffer = new int32[step * 2];
+	uint32 millis = 0;
+	for (uint32 pos = 0; pos < seconds * 8; ++pos) {
+		// Retrigger every channel with a new note each step
+		for (int c = 0; c < chips; ++c) {
+			for (int bank = 0; bank < (opl3 ? 2 : 1); ++bank) {
+				for (int ch = 0; ch < 9; ++ch) {
+					const uint16 fnum = notes[(pos + ch * 3 + bank) % ARRAYSIZE(notes)];
+					const uint32 reg = bank * 0x100 + ch;
+					chip[c]->WriteReg(reg + 0xB0, 0x00);
+					chip[c]->WriteReg(reg + 0xA0, fnum & 0xFF);
+					chip[c]->WriteReg(reg + 0xB0, 0x20 | ((2 + ch / 3) << 2) | (fnum >> 8));
+				}
+			}
+		}
+
+		const Stopwatch stopwatch;
+		for (int c = 0; c < chips; ++c) {
+			for (uint32 done = 0; done < step; ) {
+				const uint32 todo = MIN<uint32>(step - done, 512);
+				if (opl3)
+					chip[c]->GenerateBlock3(todo, buffer);
+				else
+					chip[c]->GenerateBlock2(todo, buffer);
+				done += todo;
+			}
+		}
+		millis += stopwatch.elapsed();
+	}
+
+	con->DebugPrintf("Rendered %d s of %s audio on %d chip(s) in %d ms", seconds, opl3 ? "OPL3" : "OPL2", chips, millis);
+	printRate(con, ", %.2fx realtime per chip", (float)seconds * chips, millis);
+	con->DebugPrintf("\n");
+
+	for (int c = 0; c < chips; ++c)
+		delete chip[c];
+	delete[] chip;
+	delete[] buffer;
+	return true;
+}
+#endif
+
+// Converts a 4:2:0 frame to the screen format, once through YUV2RGB and
+// PixelFormat::RGBToColor per pixel and once through Graphics::YUVToRGB
+static bool benchYUV(GUI::Debugger *con, int argc, const char **argv) {
+	const int width = (argc > 1) ? atoi(argv[1]) : 640;
+	const int height = (argc > 2) ? atoi(argv[2]) : 480;
+	const int frames = (argc > 3) ? atoi(argv[3]) : 100;
+
+	if (width < 2 || height < 2 || width > 4096 || height > 4096 || frames < 1)
+		return false;
+
+	const Graphics::PixelFormat format = getTrueColorFormat();
+	const int uvPitch = (width + 1) / 2;
+	const int uvSize = uvPitch * ((height + 1) / 2);
+	byte *planeY = new byte[width * height];
+	byte *planeU = new byte[uvSize];
+	byte *planeV = new byte[uvSize];
+	byte *dst = new byte[width * height * format.bytesPerPixel];
+
+	uint32 seed = 1;
+	for (int i = 0; i < width * height; ++i) {
+		seed = seed * 1103515245 + 12345;
+		planeY[i] = seed >> 16;
+		if (i < uvSize) {
+			planeU[i] = seed >> 8;
+			planeV[i] = seed >> 24;
+		}
+	}
+
+	Stopwatch stopwatch;
+	for (int frame = 0; frame < frames; ++frame) {
+		for (int y = 0; y < height; ++y) {
+			byte *row = dst + y * width * format.bytesPerPixel;
+			for (int x = 0; x < width; ++x) {
+				byte r, g, b;
+				const int uv = (y / 2) * uvPitch + x / 2;
+				Graphics::YUV2RGB(planeY[y * width + x], planeU[uv], planeV[uv], r, g, b);
+				if (format.bytesPerPixel == 2)
+					*((uint16 *)row + x) = format.RGBToColor(r, g, b);
+				else
+					*((uint32 *)row + x) = format.RGBToColor(r, g, b);
+			}
+		}
+	}
+	const uint32 perPixel = stopwatch.elapsed();
+
+	Graphics::YUVToRGB converter(format);
+	stopwatch.restart();
+	for (int frame = 0; frame < frames; ++frame)
+		converter.convert420(dst, width * format.bytesPerPixel, planeY, planeU, planeV, width, height, width, uvPitch);
+	const uint32 converted = stopwatch.elapsed();
+
+	con->DebugPrintf("%d frames of %dx%d at %d bpp: per pixel %d ms, YUVToRGB %d ms",
+	                 frames, width, height, format.bytesPerPixel * 8, perPixel, converted);
+	if (converted)
+		con->DebugPrintf(" (%.2fx)", (float)perPixel / converted);
+	con->DebugPrintf("\n");
+
+	delete[] planeY;
+	delete[] planeU;
+	delete[] planeV;
+	delete[] dst;
+	return true;
+}
+
+// Decodes a whole Smacker video as fast as possible, without showing it
+static bool benchSmacker(GUI::Debugger *con, int argc, const char **argv) {
+	if (argc < 2)
+		return false;
+
+	// The audio goes to a mixer which is never read from
+	Audio::MixerImpl mixer(g_system, 44100);
+	mixer.setReady(true);
+
+	Video::SmackerDecoder decoder(&mixer);
+	if (!decoder.loadFile(argv[1])) {
+		con->DebugPrintf("Could not load '%s'\n", argv[1]);
+		return true;
+	}
+
+	uint32 frames = 0;
+	const Stopwatch stopwatch;
+	while (!decoder.endOfVideo()) {
+		decoder.decodeNextFrame();
+		frames++;
+	}
+	const uint32 millis = stopwatch.elapsed();
+
+	con->DebugPrintf("Decoded %d frames of %dx%d in %d ms", frames, decoder.getWidth(), decoder.getHeight(), millis);
+	printRate(con, ", %.1f frames/s", frames, millis);
+	con->DebugPrintf("\n");
+
+	decoder.close();
+	return true;
+}
+
+// Decodes a JPEG image from memory a number of times, then converts it
+// to the screen format, and reports the time spent in both steps
+static bool benchJPEG(GUI::Debugger *con, int argc, const char **argv) {
+	const int repeats = (argc > 2) ? atoi(argv[2]) : 20;
+	if (argc < 2 || repeats < 1)
+		return false;
+
+	uint32 size;
+	byte *data = readFile(con, argv[1], size);
+	if (!data)
+		return true;
+
+	const Graphics::PixelFormat format = getTrueColorFormat();
+
+	Graphics::JPEG jpeg;
+	uint32 decoded = 0, converted = 0;
+	for (int i = 0; i < repeats; ++i) {
+		Common::MemoryReadStream stream(data, size);
+		Stopwatch stopwatch;
+		if (!jpeg.read(&stream)) {
+			con->DebugPrintf("Could not decode '%s'\n", argv[1]);
+			delete[] data;
+			return true;
+		}
+		decoded += stopwatch.elapsed();
+
+		stopwatch.restart();
+		Graphics::Surface *surface = jpeg.getSurface(format);
+		converted += stopwatch.elapsed();
+		surface->free();
+		delete surface;
+	}
+
+	con->DebugPrintf("Decoded %dx%d image %d times in %d ms, converted in %d ms",
+	                 jpeg.getWidth(), jpeg.getHeight(), repeats, decoded, converted);
+	printRate(con, ", %.2f MB/s", (float)size * repeats / 1000000.0f, decoded);
+	printRate(con, ", %.2f Mpixels/s", (float)jpeg.getWidth() * jpeg.getHeight() * repeats / 1000000.0f, decoded);
+	con->DebugPrintf("\n");
+
+	delete[] data;
+	return true;
+}
+
+static Graphics::DrawStep benchmarkStep(Graphics::DrawingFunctionCallback call, int fillMode, int radius, int shadow) {
+	Graphics::DrawStep step;
+	memset(&step, 0, sizeof(step));
+
+	step.fgColor.r = 64; step.fgColor.g = 64; step.fgColor.b = 64; step.fgColor.set = true;
+	step.bgColor.r = 240; step.bgColor.g = 228; step.bgColor.b = 196; step.bgColor.set = true;
+	step.gradColor1.r = 214; step.gradColor1.g = 113; step.gradColor1.b = 8; step.gradColor1.set = true;
+	step.gradColor2.r = 240; step.gradColor2.g = 200; step.gradColor2.b = 25; step.gradColor2.set = true;
+	step.bevelColor.r = 160; step.bevelColor.g = 160; step.bevelColor.b = 160; step.bevelColor.set = true;
+
+	step.autoWidth = step.autoHeight = true;
+	step.xAlign = step.yAlign = Graphics::DrawStep::kVectorAlignManual;
+	step.fillMode = fillMode;
+	step.radius = radius;
+	step.shadow = shadow;
+	step.stroke = 1;
+	step.bevel = 2;
+	step.factor = 1;
+	step.scale = 1 << 16;
+	step.drawingCall = call;
+	return step;
+}
+
+// Draws a dialog resembling the launcher with the draw steps the built-in
+// themes use most: a gradient background, rounded buttons with shadows,
+// tabs, a beveled list box and a scrollbar
+static void drawBenchmarkDialog(Graphics::VectorRenderer *renderer, int width, int height) {
+	typedef Graphics::VectorRenderer VR;
+	static const Graphics::DrawStep background = benchmarkStep(&VR::drawCallback_FILLSURFACE, VR::kFillGradient, 0, 0);
+	static const Graphics::DrawStep dialog = benchmarkStep(&VR::drawCallback_ROUNDSQ, VR::kFillBackground, 8, 3);
+	static const Graphics::DrawStep tab = benchmarkStep(&VR::drawCallback_TAB, VR::kFillGradient, 4, 0);
+	static const Graphics::DrawStep list = benchmarkStep(&VR::drawCallback_BEVELSQ, VR::kFillBackground, 0, 0);
+	static const Graphics::DrawStep button = benchmarkStep(&VR::drawCallback_ROUNDSQ, VR::kFillGradient, 5, 2);
+	static const Graphics::DrawStep scrollbar = benchmarkStep(&VR::drawCallback_SQUARE, VR::kFillForeground, 0, 0);
+	static const Graphics::DrawStep arrow = benchmarkStep(&VR::drawCallback_TRIANGLE, VR::kFillForeground, 0, 0);
+
+	const int unit = MAX(height / 50, 1);
+	const Common::Rect area(unit * 4, unit * 4, width - unit * 4, height - unit * 4);
+
+	renderer->drawStep(Common::Rect(width, height), background);
+	renderer->drawStep(area, dialog);
+
+	const int tabWidth = area.width() / 6;
+	for (int i = 0; i < 4; ++i)
+		renderer->drawStep(Common::Rect(area.left + unit * 2 + i * tabWidth, area.top + unit * 2,
+		                                area.left + unit * 2 + (i + 1) * tabWidth - unit, area.top + unit * 6), tab);
+
+	const Common::Rect listArea(area.left + unit * 2, area.top + unit * 7, area.right - unit * 20, area.bottom - unit * 8);
+	renderer->drawStep(listArea, list);
+	renderer->drawStep(Common::Rect(listArea.right - unit * 3, listArea.top, listArea.right, listArea.bottom), scrollbar);
+	renderer->drawStep(Common::Rect(listArea.right - unit * 3, listArea.top, listArea.right, listArea.top + unit * 3), arrow, VR::kTriangleUp);
+	renderer->drawStep(Common::Rect(listArea.right - unit * 3, listArea.bottom - unit * 3, listArea.right, listArea.bottom), arrow, VR::kTriangleDown);
+
+	for (int i = 0; i < 6; ++i)
+		renderer->drawStep(Common::Rect(area.right - unit * 17, area.top + unit * (7 + i * 5),
+		                                area.right - unit * 2, area.top + unit * (11 + i * 5)), button);
+	for (int i = 0; i < 3; ++i)
+		renderer->drawStep(Common::Rect(area.left + unit * (2 + i * 17), area.bottom - unit * 6,
+		                                area.left + unit * (17 + i * 17), area.bottom - unit * 2), button);
+}
+
+// Renders a synthetic launcher-like dialog with each of the GUI renderers at
+// a few overlay sizes, and reports the frame rate
+static bool benchGUI(GUI::Debugger *con, int argc, const char **argv) {
+	const int frames = (argc > 1) ? atoi(argv[1]) : 100;
+	if (frames < 1)
+		return false;
+
+	static const struct {
+		int mode;
+		const char *name;
+	} modes[] = {
+		{ GUI::ThemeEngine::kGfxStandard16bit, "standard" },
+#ifndef DISABLE_FANCY_THEMES
+		{ GUI::ThemeEngine::kGfxAntialias16bit, "antialiased" },
+#endif
+	};
+	static const int sizes[][2] = { { 320, 200 }, { 640, 480 }, { 1280, 960 } };
+
+	for (int m = 0; m < ARRAYSIZE(modes); ++m) {
+		Graphics::VectorRenderer *renderer = Graphics::createRenderer(modes[m].mode);
+		if (!renderer)
+			continue;
+
+		for (int s = 0; s < ARRAYSIZE(sizes); ++s) {
+			Graphics::Surface surface;
+			surface.create(sizes[s][0], sizes[s][1], sizeof(OverlayColor));
+			renderer->setSurface(&surface);
+
+			const Stopwatch stopwatch;
+			for (int frame = 0; frame < frames; ++frame)
+				drawBenchmarkDialog(renderer, surface.w, surface.h);
+			const uint32 millis = stopwatch.elapsed();
+
+			con->DebugPrintf("%s %dx%d: %d frames in %d ms", modes[m].name, surface.w, surface.h, frames, millis);
+			printRate(con, ", %.1f frames/s", frames, millis);
+			con->DebugPrintf("\n");
+
+			surface.free();
+		}
+
+		delete renderer;
+	}
+
+	return true;
+}
+
+// Opens a ZIP archive, lists its files and reads every one of them
+// completely, and reports the time spent in each step
+static bool benchZIP(GUI::Debugger *con, int argc, const char **argv) {
+	if (argc < 2)
+		return false;
+
+	Stopwatch stopwatch;
+	Common::Archive *archive = Common::makeZipArchive(argv[1]);
+	if (!archive) {
+		con->DebugPrintf("Could not open '%s'\n", argv[1]);
+		return true;
+	}
+	const uint32 opened = stopwatch.elapsed();
+
+	stopwatch.restart();
+	Common::ArchiveMemberList members;
+	archive->listMembers(members);
+	const uint32 listed = stopwatch.elapsed();
+
+	byte *buffer = new byte[65536];
+	uint32 bytes = 0, failed = 0;
+	stopwatch.restart();
+	for (Common::ArchiveMemberList::const_iterator i = members.begin(); i != members.end(); ++i) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		if (!stream) {
+			failed++;
+			continue;
+		}
+
+		uint32 read;
+		while ((read = stream->read(buffer, 65536)) > 0)
+			bytes += read;
+		if (stream->err())
+			failed++;
+
+		delete stream;
+	}
+	const uint32 millis = stopwatch.elapsed();
+	delete[] buffer;
+	delete archive;
+
+	con->DebugPrintf("Opened in %d ms, listed %d files in %d ms\n", opened, members.size(), listed);
+	con->DebugPrintf("Read %d bytes in %d ms", bytes, millis);
+	printRate(con, ", %.2f MB/s", bytes / 1000000.0f, millis);
+	con->DebugPrintf("\n");
+	if (failed)
+		con->DebugPrintf("%d files could not be read\n", failed);
+
+	return true;
+}
+
+struct Benchmark {
+	const char *name;
+	const char *arguments;
+	const char *description;
+
+	/** Run the benchmark, return false if the arguments are invalid. */
+	bool (*run)(GUI::Debugger *con, int argc, const char **argv);
+};
+
+static const Benchmark benchmarks[] = {
+	{ "midi", "<midi file> [mt32|fluidsynth|adlib|towns] [seconds]",
+	  "Renders a standard MIDI file offline and reports the realtime factor", benchMidi },
+#ifndef DISABLE_DOSBOX_OPL
+	{ "opl", "[chips] [seconds] [opl2|opl3]",
+	  "Renders a synthetic tune through the DOSBox OPL emulator", benchOPL },
+#endif
+	{ "yuv", "[width] [height] [frames]",
+	  "Times YUV 4:2:0 to RGB conversion of a frame in the screen format", benchYUV },
+	{ "smk", "<smk file>",
+	  "Decodes all frames of a Smacker video and reports the frame rate", benchSmacker },
+	{ "jpeg", "<jpeg file> [repeats]",
+	  "Decodes a JPEG image repeatedly and reports the decoding speed", benchJPEG },
+	{ "gui", "[frames]",
+	  "Renders a dialog with the GUI vector renderers and reports the frame rate", benchGUI },
+	{ "zip", "<zip file>",
+	  "Reads all files in a ZIP archive and reports the reading speed", benchZIP },
+	{ 0, 0, 0, 0 }
+};
+
+void runBenchmark(GUI::Debugger *con, int argc, const char **argv) {
+	if (argc > 1) {
+		for (const Benchmark *b = benchmarks; b->name; ++b) {
+			if (strcmp(argv[1], b->name))
+				continue;
+
+			if (!b->run(con, argc - 1, argv + 1))
+				con->DebugPrintf("Usage: %s %s %s\n%s.\n", argv[0], b->name, b->arguments, b->description);
+			return;
+		}
+	}
+
+	con->DebugPrintf("Usage: %s <benchmark> [arguments]\n\nAvailable benchmarks:\n", argv[0]);
+	for (const Benchmark *b = benchmarks; b->name; ++b)
+		con->DebugPrintf("  %-5s %s\n", b->name, b->description);
+}
+
+} // End of namespace Base
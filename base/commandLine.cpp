@@ -29,12 +29,15 @@
 #include "base/version.h"
 
 #include "common/config-manager.h"
+#include "common/file.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/fs.h"
 
 #include "gui/ThemeEngine.h"
 
+#include "audio/fmopl.h"
+
 #define DETECTOR_TESTING_HACK
 #define UPGRADE_ALL_TARGETS_HACK
 
@@ -104,6 +107,9 @@ static const char HELP_STRING[] =
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
 	"  --opl-driver=DRIVER      Select AdLib (OPL) emulator (db, mame)\n"
+	"  --opl-capture=FILE       Log all writes to the AdLib (OPL) emulator to FILE\n"
+	"  --opl-replay=FILE        Replay an OPL capture through all emulators, report\n"
+	"                           their speed and compare their output, then exit\n"
 	"  --aspect-ratio           Enable aspect ratio correction\n"
 	"  --render-mode=MODE       Enable additional render modes (cga, ega, hercGreen,\n"
 	"                           hercAmber, amiga)\n"
@@ -177,6 +183,8 @@ void registerDefaults() {
 	ConfMan.registerDefault("native_mt32", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("midi_render_ahead", 0);
+	ConfMan.registerDefault("video_decode_ahead", 0);
 //	ConfMan.registerDefault("music_driver", ???);
 
 	ConfMan.registerDefault("mt32_device", "null");
@@ -386,6 +394,13 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION("opl-driver")
 			END_OPTION
 
+			DO_LONG_OPTION("opl-capture")
+			END_OPTION
+
+			DO_LONG_OPTION("opl-replay")
+				return "opl-replay";
+			END_OPTION
+
 			DO_OPTION('g', "gfx-mode")
 			END_OPTION
 
@@ -688,6 +703,90 @@ static void listThemes() {
 		printf("%-14s %s\n", i->id.c_str(), i->name.c_str());
 }
 
+/** Replay an OPL capture through all emulators supporting its chip type. */
+static Common::Error replayOPLCapture(const char *filename) {
+	Common::File file;
+	OPL::Capture capture;
+
+	if (!file.open(filename))
+		return Common::kPathDoesNotExist;
+	if (!capture.load(file)) {
+		printf("'%s' is not a valid OPL capture\n", filename);
+		return Common::kUnknownError;
+	}
+
+	static const uint32 typeFlags[] = { OPL::Config::kFlagOpl2, OPL::Config::kFlagDualOpl2, OPL::Config::kFlagOpl3 };
+	const uint32 length = capture.getLength();
+	const int rate = capture.getRate();
+
+	printf("Replaying %.1f s of OPL writes at %d Hz\n", (float)length / rate, rate);
+	printf("Emulator   Time (ms)   Samples/s     Realtime   Hash       Difference\n");
+	printf("---------- ----------- ------------- ---------- ---------- ------------------\n");
+
+	// The output of the first emulator is what all others are compared against
+	int16 *reference = 0;
+	uint32 referenceSize = 0;
+	const char *referenceName = 0;
+
+	for (const OPL::Config::EmulatorDescription *ed = OPL::Config::getAvailable(); ed->name; ++ed) {
+		if (ed->id == 0 || !(ed->flags & typeFlags[capture.getType()]))
+			continue;
+
+		OPL::OPL *opl = OPL::Config::create(ed->id, capture.getType());
+		if (!opl || !opl->init(rate)) {
+			printf("%-10s could not be initialized\n", ed->name);
+			delete opl;
+			continue;
+		}
+
+		const uint32 size = length * (opl->isStereo() ? 2 : 1);
+		int16 *buffer = new int16[size];
+
+		const uint32 start = g_system->getMillis();
+		capture.replay(opl, buffer);
+		const uint32 millis = g_system->getMillis() - start;
+		delete opl;
+
+		// FNV-1a, to compare the output with other builds
+		uint32 hash = 2166136261u;
+		for (uint32 i = 0; i < size; ++i) {
+			hash = (hash ^ (buffer[i] & 0xFF)) * 16777619;
+			hash = (hash ^ ((buffer[i] >> 8) & 0xFF)) * 16777619;
+		}
+
+		printf("%-10s %11d %13.0f %9.1fx 0x%08x ", ed->name, millis,
+			millis ? length * 1000.0f / millis : 0.0f,
+			millis ? length * 1000.0f / (millis * (float)rate) : 0.0f, hash);
+
+		if (!reference) {
+			printf("reference\n");
+			reference = buffer;
+			referenceSize = size;
+			referenceName = ed->name;
+			continue;
+		}
+
+		if (size != referenceSize) {
+			printf("not comparable to %s\n", referenceName);
+		} else {
+			uint32 differences = 0;
+			int peak = 0;
+			for (uint32 i = 0; i < size; ++i) {
+				const int delta = ABS(buffer[i] - reference[i]);
+				if (delta) {
+					++differences;
+					peak = MAX(peak, delta);
+				}
+			}
+			printf("%d samples, peak %d\n", differences, peak);
+		}
+		delete[] buffer;
+	}
+
+	delete[] reference;
+	return Common::kNoError;
+}
+
 
 #ifdef DETECTOR_TESTING_HACK
 static void runDetectorTest() {
@@ -720,7 +819,9 @@ static void runDetectorTest() {
 			continue;
 		}
 
+		const uint32 start = g_system->getMillis();
 		GameList candidates(EngineMan.detectGames(files));
+		printf(" ... detection took %d ms\n", g_system->getMillis() - start);
 		bool gameidDiffers = false;
 		GameList::iterator x;
 		for (x = candidates.begin(); x != candidates.end(); ++x) {
@@ -903,6 +1004,8 @@ Common::Error processSettings(Common::String &command, Common::StringMap &settin
 	} else if (command == "list-themes") {
 		listThemes();
 		return Common::kNoError;
+	} else if (command == "opl-replay") {
+		return replayOPLCapture(settings["opl-replay"].c_str());
 	} else if (command == "version") {
 		printf("%s\n", gScummVMFullVersion);
 		printf("Features compiled in: %s\n", gScummVMFeatures);
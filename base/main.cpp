@@ -44,6 +44,7 @@
 #include "common/events.h"
 #include "common/EventRecorder.h"
 #include "common/fs.h"
+#include "common/md5cache.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/tokenizer.h"
@@ -135,6 +136,9 @@ static Common::Error runGame(const EnginePlugin *plugin, OSystem &system, const
 	if (err.getCode() == Common::kNoError)
 		err = (*plugin)->createInstance(&system, &engine);
 
+	// Save the checksums computed while detecting the game
+	MD5Man.flush();
+
 	// Check for errors
 	if (!engine || err.getCode() != Common::kNoError) {
 
@@ -360,6 +364,9 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	// the command line params) was read.
 	system.initBackend();
 
+	// The detection checksums are kept in a save file
+	MD5Man.load();
+
 	// If we received an invalid graphics mode parameter via command line
 	// we check this here. We can't do it until after the backend is inited,
 	// or there won't be a graphics manager to ask for the supported modes.
@@ -461,6 +468,8 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		setupGraphics(system);
 		launcherDialog();
 	}
+	MD5Man.flush();
+	Common::MD5Cache::destroy();
 	PluginManager::instance().unloadAllPlugins();
 	PluginManager::destroy();
 	GUI::GuiManager::destroy();
@@ -2,6 +2,7 @@ MODULE := base
 
 MODULE_OBJS := \
 	main.o \
+	benchmark.o \
 	commandLine.o \
 	plugins.o \
 	version.o
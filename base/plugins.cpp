@@ -28,6 +28,12 @@
 #include "common/func.h"
 #include "common/debug.h"
 #include "common/config-manager.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/tokenizer.h"
+
+#include "engines/metaengine.h"
 
 #ifdef DYNAMIC_MODULES
 #include "common/fs.h"
@@ -393,7 +399,9 @@ bool PluginManagerUncached::loadPluginFromGameId(const Common::String &gameId) {
 			}
 		}
 	}
-	return false;
+
+	// Try the plugin which supported the game when it was last loaded
+	return loadPluginByFileName(findPluginInCache(gameId));
 }
 
 /**
@@ -432,6 +440,187 @@ void PluginManagerUncached::updateConfigWithFileName(const Common::String &gameI
 
 		ConfMan.flushToDisk();
 	}
+
+	// The scan stops here, keep what was learned about the other plugins
+	flushPluginCache();
+}
+
+// The plugin cache is a save file, as the ports using the uncached plugin
+// manager are short on memory. Lines after the header are made of tab
+// separated fields: size and modification time of the plugin file, the
+// ids of its games separated by spaces, and its name. Files with a
+// different size or modification time are not looked up, and dropped the
+// next time the cache is written. Not every file system can tell the
+// modification time, so the size alone has to do there.
+
+static const char *const kPluginCacheFile = "scummvm-plugins.cache";
+static const char *const kPluginCacheHeader = "PLUGINCACHE 1";
+
+/**
+ * Get the size and modification time fields of a plugin cache entry for
+ * the given plugin file, or an empty string if it can not be opened.
+ **/
+static Common::String getPluginCacheStamp(const Common::String &filename) {
+	Common::FSNode node(filename);
+	Common::SeekableReadStream *stream = node.createReadStream();
+	if (!stream)
+		return Common::String();
+
+	const int32 size = stream->size();
+	delete stream;
+	return Common::String::format("%d\t%u", size, node.getLastModified());
+}
+
+/**
+ * Split a plugin cache line into the stamp, the game ids and the name of
+ * the plugin file. Returns false if the line is malformed.
+ **/
+static bool parsePluginCacheLine(const Common::String &line, Common::String &stamp, Common::String &gameIds, Common::String &filename) {
+	const char *start = line.c_str();
+	const char *gameIdsStart = strchr(start, '\t');
+	if (gameIdsStart)
+		gameIdsStart = strchr(gameIdsStart + 1, '\t');
+	const char *filenameStart = gameIdsStart ? strchr(gameIdsStart + 1, '\t') : 0;
+	if (!filenameStart || !filenameStart[1])
+		return false;
+
+	stamp = Common::String(start, gameIdsStart);
+	gameIds = Common::String(gameIdsStart + 1, filenameStart);
+	filename = Common::String(filenameStart + 1);
+	return true;
+}
+
+static Common::SeekableReadStream *openPluginCache() {
+	// Game detection may run from the command line, before the backend
+	// is initialized
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return 0;
+
+	Common::SeekableReadStream *stream = saveFileMan->openGlobalForLoading(kPluginCacheFile);
+	if (stream && stream->readLine() != kPluginCacheHeader) {
+		warning("Ignoring '%s', it has an unknown format", kPluginCacheFile);
+		delete stream;
+		stream = 0;
+	}
+	return stream;
+}
+
+/**
+ * Look up the plugin file which supports the given game id in the plugin
+ * cache. Returns an empty string if there is none, or it changed.
+ **/
+Common::String PluginManagerUncached::findPluginInCache(const Common::String &gameId) {
+	Common::SeekableReadStream *stream = openPluginCache();
+	if (!stream)
+		return Common::String();
+
+	Common::String result;
+	while (result.empty() && !stream->eos() && !stream->err()) {
+		Common::String stamp, gameIds, filename;
+		if (!parsePluginCacheLine(stream->readLine(), stamp, gameIds, filename))
+			continue;
+
+		Common::StringTokenizer tokenizer(gameIds, " ");
+		while (!tokenizer.empty()) {
+			if (tokenizer.nextToken() == gameId) {
+				if (stamp == getPluginCacheStamp(filename))
+					result = filename;
+				break;
+			}
+		}
+	}
+
+	delete stream;
+	return result;
+}
+
+/**
+ * Record the games supported by a loaded plugin file, replacing what was
+ * known about it. The entry is written by the next flushPluginCache().
+ **/
+void PluginManagerUncached::addToPluginCache(Plugin *plugin) {
+	const char *filename = plugin->getFileName();
+	if (!filename || strchr(filename, '\n'))
+		return;
+
+	const Common::String stamp = getPluginCacheStamp(filename);
+	if (stamp.empty())
+		return;
+
+	Common::String gameIds;
+	const GameList games = (*(EnginePlugin *)plugin)->getSupportedGames();
+	for (GameList::const_iterator game = games.begin(); game != games.end(); ++game) {
+		if (!gameIds.empty())
+			gameIds += ' ';
+		gameIds += game->gameid();
+	}
+
+	_pluginCacheUpdates[filename] = stamp + '\t' + gameIds;
+}
+
+/**
+ * Merge the entries learned since the last call into the plugin cache
+ * file, and drop the entries of plugin files which are gone or changed.
+ * The file is only rewritten if anything changed.
+ **/
+void PluginManagerUncached::flushPluginCache() {
+	if (_pluginCacheUpdates.empty())
+		return;
+
+	Common::Array<Common::String> lines;
+	bool changed = false;
+
+	Common::SeekableReadStream *stream = openPluginCache();
+	while (stream && !stream->eos() && !stream->err()) {
+		const Common::String line = stream->readLine();
+		Common::String stamp, gameIds, filename;
+		if (!parsePluginCacheLine(line, stamp, gameIds, filename)) {
+			changed |= !line.empty();
+			continue;
+		}
+
+		Common::HashMap<Common::String, Common::String>::iterator update = _pluginCacheUpdates.find(filename);
+		if (update != _pluginCacheUpdates.end()) {
+			if (update->_value == stamp + '\t' + gameIds) {
+				lines.push_back(line);
+				_pluginCacheUpdates.erase(update);
+			} else {
+				changed = true;
+			}
+		} else if (stamp == getPluginCacheStamp(filename)) {
+			lines.push_back(line);
+		} else {
+			debug(1, "Plugin '%s' changed, forgetting its games", filename.c_str());
+			changed = true;
+		}
+	}
+	delete stream;
+
+	for (Common::HashMap<Common::String, Common::String>::const_iterator update = _pluginCacheUpdates.begin(); update != _pluginCacheUpdates.end(); ++update) {
+		lines.push_back(update->_value + '\t' + update->_key);
+		changed = true;
+	}
+	_pluginCacheUpdates.clear();
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!changed || !saveFileMan)
+		return;
+
+	Common::WriteStream *out = saveFileMan->openGlobalForSaving(kPluginCacheFile);
+	if (!out) {
+		warning("Could not write '%s'", kPluginCacheFile);
+		return;
+	}
+
+	out->writeString(kPluginCacheHeader);
+	out->writeByte('\n');
+	for (uint i = 0; i < lines.size(); ++i) {
+		out->writeString(lines[i]);
+		out->writeByte('\n');
+	}
+	out->finalize();
+	delete out;
 }
 
 void PluginManagerUncached::loadFirstPlugin() { 
@@ -441,6 +630,7 @@ void PluginManagerUncached::loadFirstPlugin() {
 	for (_currentPlugin = _allEnginePlugins.begin(); _currentPlugin != _allEnginePlugins.end(); ++_currentPlugin) {
 		if ((*_currentPlugin)->loadPlugin()) {
 			addToPluginsInMemList(*_currentPlugin);
+			addToPluginCache(*_currentPlugin);
 			break;
 		}
 	}
@@ -452,9 +642,13 @@ bool PluginManagerUncached::loadNextPlugin() {
 	for (++_currentPlugin; _currentPlugin != _allEnginePlugins.end(); ++_currentPlugin) {
 		if ((*_currentPlugin)->loadPlugin()) {
 			addToPluginsInMemList(*_currentPlugin);
+			addToPluginCache(*_currentPlugin);
 			return true;
 		}
 	}
+
+	// All plugins were looked at, so keep what was learned about them
+	flushPluginCache();
 	return false;	// no more in list
 }
 
@@ -537,8 +731,6 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 
 // Engine plugins
 
-#include "engines/metaengine.h"
-
 DECLARE_SINGLETON(EngineManager);
 
 /** 
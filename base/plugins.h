@@ -28,6 +28,8 @@
 
 #include "common/array.h"
 #include "common/fs.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/str.h"
 #include "backends/plugins/elf/version.h"
 
@@ -351,9 +353,18 @@ protected:
 	PluginList _allEnginePlugins;
 	PluginList::iterator _currentPlugin;
 
+	// Plugin cache entries learned since the cache file was last written,
+	// by plugin file name
+	Common::HashMap<Common::String, Common::String> _pluginCacheUpdates;
+
 	PluginManagerUncached() {}
 	bool loadPluginByFileName(const Common::String &filename); 
 
+	// The plugin cache remembers the games each plugin file supports
+	Common::String findPluginInCache(const Common::String &gameId);
+	void addToPluginCache(Plugin *plugin);
+	void flushPluginCache();
+
 public:
 	virtual void init();
 	virtual void loadFirstPlugin();
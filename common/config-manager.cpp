@@ -27,6 +27,8 @@
 #include "common/debug.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
@@ -51,7 +53,7 @@ const char *ConfigManager::kKeymapperDomain = "keymapper";
 #pragma mark -
 
 
-ConfigManager::ConfigManager() : _activeDomain(0) {
+ConfigManager::ConfigManager() : _activeDomain(0), _flushedValid(false) {
 }
 
 void ConfigManager::defragment() {
@@ -74,6 +76,8 @@ void ConfigManager::copyFrom(ConfigManager &source) {
 	_activeDomainName = source._activeDomainName;
 	_activeDomain = &_gameDomains[_activeDomainName];
 	_filename = source._filename;
+	_flushedValid = source._flushedValid;
+	memcpy(_flushedMD5, source._flushedMD5, sizeof(_flushedMD5));
 }
 
 
@@ -82,6 +86,7 @@ void ConfigManager::loadDefaultConfigFile() {
 	assert(g_system);
 	SeekableReadStream *stream = g_system->createConfigReadStream();
 	_filename.clear();  // clear the filename to indicate that we are using the default config file
+	_flushedValid = false;
 
 	// ... load it, if available ...
 	if (stream) {
@@ -100,6 +105,7 @@ void ConfigManager::loadDefaultConfigFile() {
 
 void ConfigManager::loadConfigFile(const String &filename) {
 	_filename = filename;
+	_flushedValid = false;
 
 	FSNode node(filename);
 	File cfg_file;
@@ -164,16 +170,33 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 	_keymapperDomain.clear();
 #endif
 
+	const uint32 start = g_system->getMillis();
+
+	// Read the whole file at once, and split it into lines in place, so
+	// only the keys and values have to be copied.
+	const int32 size = MAX<int32>(stream.size() - stream.pos(), 0);
+	char *buffer = new char[size + 1];
+	char *end = buffer + stream.read(buffer, size);
+	char *next = buffer;
+
 	// TODO: Detect if a domain occurs multiple times (or likewise, if
 	// a key occurs multiple times inside one domain).
 
-	while (!stream.eos() && !stream.err()) {
+	while (next < end) {
 		lineno++;
 
-		// Read a line
-		String line = stream.readLine();
+		// Find the end of the line. CR, LF and CR/LF all end a line.
+		char *line = next;
+		char *eol = line;
+		while (eol < end && *eol != '\n' && *eol != '\r')
+			eol++;
 
-		if (line.size() == 0) {
+		next = eol;
+		if (next < end && *next++ == '\r' && next < end && *next == '\n')
+			next++;
+		*eol = 0;
+
+		if (*line == 0) {
 			// Do nothing
 		} else if (line[0] == '#') {
 			// Accumulate comments here. Once we encounter either the start
@@ -185,8 +208,8 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 			// It's a new domain which begins here.
 			// Determine where the previously accumulated domain goes, if we accumulated anything.
 			addDomain(domainName, domain);
-			domain.clear();
-			const char *p = line.c_str() + 1;
+			domain = Domain();
+			const char *p = line + 1;
 			// Get the domain name, and check whether it's valid (that
 			// is, verify that it only consists of alphanumerics,
 			// dashes and underscores).
@@ -198,7 +221,7 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 			else if (*p != ']')
 				error("Config file buggy: Invalid character '%c' occurred in section name in line %d", *p, lineno);
 
-			domainName = String(line.c_str() + 1, p);
+			domainName = String(line + 1, p);
 
 			domain.setDomainComment(comment);
 			comment.clear();
@@ -207,7 +230,7 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 			// This line should be a line with a 'key=value' pair, or an empty one.
 
 			// Skip leading whitespaces
-			const char *t = line.c_str();
+			const char *t = line;
 			while (isspace(*t))
 				t++;
 
@@ -225,82 +248,121 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 			if (!p)
 				error("Config file buggy: Junk found in line line %d: '%s'", lineno, t);
 
-			// Extract the key/value pair
-			String key(t, p);
-			String value(p + 1);
+			// Trim off spaces around the key and the value
+			const char *keyEnd = p;
+			while (keyEnd > t && isspace(keyEnd[-1]))
+				keyEnd--;
+
+			const char *value = p + 1;
+			while (isspace(*value))
+				value++;
 
-			// Trim of spaces
-			key.trim();
-			value.trim();
+			const char *valueEnd = eol;
+			while (valueEnd > value && isspace(valueEnd[-1]))
+				valueEnd--;
 
 			// Finally, store the key/value pair in the active domain
-			domain[key] = value;
+			const String key(t, keyEnd);
+			domain[key] = String(value, valueEnd);
 
 			// Store comment
-			domain.setKVComment(key, comment);
-			comment.clear();
+			if (!comment.empty()) {
+				domain.setKVComment(key, comment);
+				comment.clear();
+			}
 		}
 	}
 
 	addDomain(domainName, domain); // Add the last domain found
+
+	delete[] buffer;
+
+	debug(2, "Read %d bytes of configuration in %d ms", size, g_system->getMillis() - start);
 }
 
 void ConfigManager::flushToDisk() {
 #ifndef __DC__
-	WriteStream *stream;
-
-	if (_filename.empty()) {
-		// Write to the default config file
-		assert(g_system);
-		stream = g_system->createConfigWriteStream();
-		if (!stream)    // If writing to the config file is not possible, do nothing
-			return;
-	} else {
-		DumpFile *dump = new DumpFile();
-		assert(dump);
-
-		if (!dump->open(_filename)) {
-			warning("Unable to write configuration file: %s", _filename.c_str());
-			delete dump;
-			return;
-		}
+	const uint32 start = g_system->getMillis();
 
-		stream = dump;
-	}
+	// Serialize the configuration in memory first. This way the file is
+	// written in one go, and not at all if it did not change since it was
+	// last written.
+	MemoryWriteStreamDynamic buffer(DisposeAfterUse::YES);
 
 	// Write the application domain
-	writeDomain(*stream, kApplicationDomain, _appDomain);
+	writeDomain(buffer, kApplicationDomain, _appDomain);
 
 #ifdef ENABLE_KEYMAPPER
 	// Write the keymapper domain
-	writeDomain(*stream, kKeymapperDomain, _keymapperDomain);
+	writeDomain(buffer, kKeymapperDomain, _keymapperDomain);
 #endif
 
 	DomainMap::const_iterator d;
 
 	// Write the miscellaneous domains next
 	for (d = _miscDomains.begin(); d != _miscDomains.end(); ++d) {
-		writeDomain(*stream, d->_key, d->_value);
+		writeDomain(buffer, d->_key, d->_value);
 	}
 
 	// First write the domains in _domainSaveOrder, in that order.
 	// Note: It's possible for _domainSaveOrder to list domains which
 	// are not present anymore, so we validate each name.
+	HashMap<String, bool> ordered;
 	Array<String>::const_iterator i;
 	for (i = _domainSaveOrder.begin(); i != _domainSaveOrder.end(); ++i) {
+		ordered[*i] = true;
 		if (_gameDomains.contains(*i)) {
-			writeDomain(*stream, *i, _gameDomains[*i]);
+			writeDomain(buffer, *i, _gameDomains[*i]);
 		}
 	}
 
 	// Now write the domains which haven't been written yet
 	for (d = _gameDomains.begin(); d != _gameDomains.end(); ++d) {
-		if (find(_domainSaveOrder.begin(), _domainSaveOrder.end(), d->_key) == _domainSaveOrder.end())
-			writeDomain(*stream, d->_key, d->_value);
+		if (!ordered.contains(d->_key))
+			writeDomain(buffer, d->_key, d->_value);
 	}
 
+	uint8 md5[16];
+	MemoryReadStream data(buffer.getData(), buffer.size());
+	computeStreamMD5(data, md5);
+
+	if (_flushedValid && !memcmp(md5, _flushedMD5, sizeof(md5))) {
+		debug(2, "Configuration unchanged, not writing it");
+		return;
+	}
+
+	WriteStream *stream;
+
+	if (_filename.empty()) {
+		// Write to the default config file
+		assert(g_system);
+		stream = g_system->createConfigWriteStream();
+		if (!stream)    // If writing to the config file is not possible, do nothing
+			return;
+	} else {
+		DumpFile *dump = new DumpFile();
+		assert(dump);
+
+		if (!dump->open(_filename)) {
+			warning("Unable to write configuration file: %s", _filename.c_str());
+			delete dump;
+			return;
+		}
+
+		stream = dump;
+	}
+
+	stream->write(buffer.getData(), buffer.size());
+	stream->finalize();
+
+	// Only skip the next write if this one succeeded
+	_flushedValid = !stream->err();
+	memcpy(_flushedMD5, md5, sizeof(md5));
+
 	delete stream;
 
+	debug(2, "Wrote %d bytes of configuration in %d ms", buffer.size(), g_system->getMillis() - start);
+
 #endif // !__DC__
 }
 
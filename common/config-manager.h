@@ -127,6 +127,10 @@ public:
 	void				registerDefault(const String &key, int value);
 	void				registerDefault(const String &key, bool value);
 
+	/**
+	 * Write the configuration to the config file. Nothing is written if the
+	 * configuration did not change since the last time it was written.
+	 */
 	void				flushToDisk();
 
 	void				setActiveDomain(const String &domName);
@@ -176,6 +180,9 @@ private:
 	Domain *		_activeDomain;
 
 	String			_filename;
+
+	bool			_flushedValid;		// Whether _flushedMD5 is the checksum of the file on disk
+	uint8			_flushedMD5[16];	// Checksum of the data last written by flushToDisk
 };
 
 }	// End of namespace Common
@@ -127,6 +127,10 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+uint32 FSNode::getLastModified() const {
+	return _realNode ? _realNode->getLastModified() : 0;
+}
+
 Common::SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == 0)
 		return 0;
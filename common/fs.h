@@ -208,6 +208,14 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Returns the time of the last modification of the object referred by
+	 * this node, in seconds since an epoch defined by the file system.
+	 *
+	 * @return the modification time, or 0 if the file system can not tell.
+	 */
+	uint32 getLastModified() const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -0,0 +1,166 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+
+#include "common/md5cache.h"
+#include "common/file.h"
+#include "common/fs.h"
+#include "common/md5.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+DECLARE_SINGLETON(Common::MD5Cache);
+
+namespace Common {
+
+static const char *const kMD5CacheFile = "scummvm-md5.cache";
+static const char *const kMD5CacheHeader = "MD5CACHE 1";
+
+// Keeps the cache file small, as entries of files which were deleted or
+// moved are never looked up again
+static const uint kMD5CacheMaxEntries = 4096;
+
+// Lines of the cache file, after the header, are made of tab separated
+// fields: length, size, modification time, MD5 and path. The path comes
+// last, as it is the only field which may contain tabs.
+
+MD5Cache::MD5Cache() : _loaded(false), _dirty(false) {
+}
+
+void MD5Cache::load() {
+	_loaded = true;
+	_entries.clear();
+
+	// The cache is shared by all games, so it must not follow the save path
+	// of the game domain, which is active when a game is launched
+	SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	SeekableReadStream *stream = saveFileMan ? saveFileMan->openGlobalForLoading(kMD5CacheFile) : 0;
+	if (!stream)
+		return;
+
+	if (stream->readLine() != kMD5CacheHeader) {
+		warning("MD5Cache: Ignoring '%s', it has an unknown format", kMD5CacheFile);
+		delete stream;
+		return;
+	}
+
+	while (!stream->eos() && !stream->err() && _entries.size() < kMD5CacheMaxEntries) {
+		String line = stream->readLine();
+
+		// Split off the four numeric fields, the path is what remains
+		const char *fields[4];
+		const char *pos = line.c_str();
+		int i;
+		for (i = 0; i < 4 && pos; i++) {
+			fields[i] = pos;
+			pos = strchr(pos, '\t');
+			if (pos)
+				pos++;
+		}
+
+		if (i < 4 || !pos || !*pos)
+			continue;
+
+		Entry entry;
+		entry.size = atoi(fields[1]);
+		entry.lastModified = strtoul(fields[2], 0, 10);
+		entry.md5 = String(fields[3], pos - 1);
+		if (entry.md5.size() != 32)
+			continue;
+
+		_entries[String::format("%u:%s", (uint32)strtoul(fields[0], 0, 10), pos)] = entry;
+	}
+
+	delete stream;
+}
+
+String MD5Cache::computeFileMD5AsString(const FSNode &node, uint32 length, int32 &size) {
+	File file;
+	if (!file.open(node)) {
+		size = -1;
+		return String();
+	}
+	size = (int32)file.size();
+
+	// File systems which can not tell the modification time report 0. There
+	// a changed file may keep its size, so the checksum is always computed.
+	const uint32 lastModified = node.getLastModified();
+	const String path = node.getPath();
+	if (!_loaded || !lastModified || strchr(path.c_str(), '\n'))
+		return computeStreamMD5AsString(file, length);
+
+	const String key = String::format("%u:%s", length, path.c_str());
+	EntryMap::iterator i = _entries.find(key);
+	if (i != _entries.end()) {
+		if (i->_value.size == size && i->_value.lastModified == lastModified)
+			return i->_value.md5;
+
+		// The file changed, so the entry is stale
+		_entries.erase(i);
+		_dirty = true;
+	}
+
+	Entry entry;
+	entry.size = size;
+	entry.lastModified = lastModified;
+	entry.md5 = computeStreamMD5AsString(file, length);
+	if (!entry.md5.empty() && _entries.size() < kMD5CacheMaxEntries) {
+		_entries[key] = entry;
+		_dirty = true;
+	}
+
+	return entry.md5;
+}
+
+void MD5Cache::flush() {
+	if (!_dirty)
+		return;
+
+	SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	WriteStream *stream = saveFileMan ? saveFileMan->openGlobalForSaving(kMD5CacheFile) : 0;
+	if (!stream) {
+		warning("MD5Cache: Could not write '%s'", kMD5CacheFile);
+		return;
+	}
+
+	stream->writeString(kMD5CacheHeader);
+	stream->writeByte('\n');
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		// The key holds the length and the path, separated by a colon
+		const char *path = strchr(i->_key.c_str(), ':') + 1;
+		const uint32 length = strtoul(i->_key.c_str(), 0, 10);
+
+		stream->writeString(String::format("%u\t%d\t%u\t%s\t%s\n", length, i->_value.size,
+		                                   i->_value.lastModified, i->_value.md5.c_str(), path));
+	}
+
+	stream->finalize();
+	if (!stream->err())
+		_dirty = false;
+	delete stream;
+}
+
+} // End of namespace Common
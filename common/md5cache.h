@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+
+#ifndef COMMON_MD5CACHE_H
+#define COMMON_MD5CACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+
+class FSNode;
+
+/**
+ * Remembers the MD5 checksums computed during game detection, so files
+ * which did not change are not read again by later scans or launches.
+ *
+ * Entries are keyed by path and the number of bytes hashed, and are only
+ * used while the size and modification time of the file stay the same.
+ * Files whose modification time the file system can not tell are not
+ * cached. Entries which no longer match their file are dropped when they
+ * are looked up, and the number of entries is limited. The cache is kept
+ * in a save file in the save path of the application.
+ */
+class MD5Cache : public Singleton<MD5Cache> {
+public:
+	/**
+	 * Compute the MD5 checksum of the given file, or look it up if the file
+	 * did not change since it was last computed.
+	 * @param[in] node		the file of whose data the MD5 is computed
+	 * @param[in] length	the number of bytes for which to compute the checksum; 0 means all
+	 * @param[out] size		the size of the file, or -1 if it could not be opened
+	 * @return the MD5 as a hex string on success, and an empty string if an error occurred
+	 */
+	String computeFileMD5AsString(const FSNode &node, uint32 length, int32 &size);
+
+	/**
+	 * Read the cache from its save file. Until this is done, every checksum
+	 * is computed. Must only be called once the backend is initialized, as
+	 * it needs the save file manager.
+	 */
+	void load();
+
+	/**
+	 * Write the cache back to its save file, if it changed.
+	 */
+	void flush();
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	MD5Cache();
+
+	struct Entry {
+		int32 size;
+		uint32 lastModified;
+		String md5;
+	};
+
+	typedef HashMap<String, Entry> EntryMap;
+	EntryMap _entries;
+
+	bool _loaded;
+	bool _dirty;
+};
+
+} // End of namespace Common
+
+/** Shortcut for accessing the MD5 cache. */
+#define MD5Man		Common::MD5Cache::instance()
+
+#endif
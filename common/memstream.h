@@ -28,6 +28,7 @@
 
 #include "common/stream.h"
 #include "common/types.h"
+#include "common/util.h"
 
 namespace Common {
 
@@ -131,7 +132,8 @@ private:
 
 		byte *old_data = _data;
 
-		_capacity = new_len + 32;
+		// Grow geometrically, so that many small writes stay linear in time
+		_capacity = MAX(new_len + 32, _capacity * 2);
 		_data = (byte *)malloc(_capacity);
 		_ptr = _data + _pos;
 
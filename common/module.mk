@@ -16,6 +16,7 @@ MODULE_OBJS := \
 	macresman.o \
 	memorypool.o \
 	md5.o \
+	md5cache.o \
 	mutex.o \
 	random.o \
 	rational.o \
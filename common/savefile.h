@@ -120,6 +120,25 @@ public:
 	 */
 	virtual InSaveFile *openForLoading(const String &name) = 0;
 
+	/**
+	 * Open the file with the specified name in the save path of the
+	 * application, for saving. Unlike openForSaving(), this ignores the save
+	 * path of the running game, so it suits data shared by all games.
+	 * The default implementation is openForSaving(), for save file managers
+	 * whose location does not depend on the running game.
+	 * @param name	the name of the savefile
+	 * @return pointer to an OutSaveFile, or NULL if an error occurred.
+	 */
+	virtual OutSaveFile *openGlobalForSaving(const String &name) { return openForSaving(name); }
+
+	/**
+	 * Open the file with the specified name in the save path of the
+	 * application, for loading. See openGlobalForSaving().
+	 * @param name	the name of the savefile
+	 * @return pointer to an InSaveFile, or NULL if an error occurred.
+	 */
+	virtual InSaveFile *openGlobalForLoading(const String &name) { return openForLoading(name); }
+
 	/**
 	 * Removes the given savefile from the system.
 	 * @param name the name of the savefile to be removed.
@@ -55,6 +55,13 @@ public:
 	 * and no instance of this callback will be running anymore.
 	 */
 	virtual void removeTimerProc(TimerProc proc) = 0;
+
+	/**
+	 * Remove the given timer callback, but only where it was installed
+	 * with the given refCon. This allows one callback to be shared by
+	 * several objects, each with its own timer.
+	 */
+	virtual void removeTimerProc(TimerProc proc, void *refCon) = 0;
 };
 
 } // End of namespace Common
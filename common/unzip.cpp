@@ -106,6 +106,7 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/substream.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -395,9 +396,14 @@ typedef struct {
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
 	file_in_zip_read_info_s* pfile_in_zip_read;		/* structure about the current
 													file if we are decompressing it */
+	file_in_zip_read_info_s* pfile_in_zip_read_cache;	/* structure of the last closed
+													file, kept for reuse */
 	ZipHash _hash;
 } unz_s;
 
+static int unzlocal_ReadCurrentFile(file_in_zip_read_info_s* pfile_in_zip_read_info, voidp buf, unsigned len);
+static void unzlocal_FreeReadInfo(file_in_zip_read_info_s* pfile_in_zip_read_info);
+
 /* ===========================================================================
      Read a byte from a gz_stream; update next_in and avail_in. Return EOF
    for end of file.
@@ -602,6 +608,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		                    (us->offset_central_dir+us->size_central_dir);
 	us->central_pos = central_pos;
 	us->pfile_in_zip_read = NULL;
+	us->pfile_in_zip_read_cache = NULL;
 
 	err = unzGoToFirstFile((unzFile)us);
 
@@ -642,6 +649,9 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
+	if (s->pfile_in_zip_read_cache != NULL)
+		unzlocal_FreeReadInfo(s->pfile_in_zip_read_cache);
+
 	delete s->_stream;
 	delete s;
 	return UNZ_OK;
@@ -1058,23 +1068,31 @@ int unzOpenCurrentFile (unzFile file) {
 				&offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
 		return UNZ_BADZIPFILE;
 
-	pfile_in_zip_read_info = (file_in_zip_read_info_s*) malloc(sizeof(file_in_zip_read_info_s));
+	/* reuse the structure of the last closed file, if any, so the read
+	   buffer and the inflate state are not set up again for every file */
+	pfile_in_zip_read_info = s->pfile_in_zip_read_cache;
+	s->pfile_in_zip_read_cache = NULL;
 
-	if (pfile_in_zip_read_info==NULL)
-		return UNZ_INTERNALERROR;
+	if (pfile_in_zip_read_info==NULL) {
+		pfile_in_zip_read_info = (file_in_zip_read_info_s*) malloc(sizeof(file_in_zip_read_info_s));
 
-	pfile_in_zip_read_info->read_buffer=(char*)malloc(UNZ_BUFSIZE);
-	pfile_in_zip_read_info->offset_local_extrafield = offset_local_extrafield;
-	pfile_in_zip_read_info->size_local_extrafield = size_local_extrafield;
-	pfile_in_zip_read_info->pos_local_extrafield=0;
+		if (pfile_in_zip_read_info==NULL)
+			return UNZ_INTERNALERROR;
 
-	if (pfile_in_zip_read_info->read_buffer==NULL)
-	{
-		free(pfile_in_zip_read_info);
-		return UNZ_INTERNALERROR;
+		pfile_in_zip_read_info->read_buffer=(char*)malloc(UNZ_BUFSIZE);
+
+		if (pfile_in_zip_read_info->read_buffer==NULL)
+		{
+			free(pfile_in_zip_read_info);
+			return UNZ_INTERNALERROR;
+		}
+
+		pfile_in_zip_read_info->stream_initialised=0;
 	}
 
-	pfile_in_zip_read_info->stream_initialised=0;
+	pfile_in_zip_read_info->offset_local_extrafield = offset_local_extrafield;
+	pfile_in_zip_read_info->size_local_extrafield = size_local_extrafield;
+	pfile_in_zip_read_info->pos_local_extrafield=0;
 
 	if ((s->cur_file_info.compression_method!=0) &&
 	    (s->cur_file_info.compression_method!=Z_DEFLATED))
@@ -1091,13 +1109,17 @@ int unzOpenCurrentFile (unzFile file) {
 
 	if (!Store) {
 #ifdef USE_ZLIB
-		pfile_in_zip_read_info->stream.zalloc = (alloc_func)0;
-		pfile_in_zip_read_info->stream.zfree = (free_func)0;
-		pfile_in_zip_read_info->stream.opaque = (voidpf)0;
+		if (pfile_in_zip_read_info->stream_initialised) {
+			err=inflateReset(&pfile_in_zip_read_info->stream);
+		} else {
+			pfile_in_zip_read_info->stream.zalloc = (alloc_func)0;
+			pfile_in_zip_read_info->stream.zfree = (free_func)0;
+			pfile_in_zip_read_info->stream.opaque = (voidpf)0;
 
-		err=inflateInit2(&pfile_in_zip_read_info->stream, -MAX_WBITS);
-		if (err == Z_OK)
-			pfile_in_zip_read_info->stream_initialised = 1;
+			err=inflateInit2(&pfile_in_zip_read_info->stream, -MAX_WBITS);
+			if (err == Z_OK)
+				pfile_in_zip_read_info->stream_initialised = 1;
+		}
 	/* windowBits is passed < 0 to tell that there is no zlib header.
 	 * Note that in this case inflate *requires* an extra "dummy" byte
 	 * after the compressed stream in order to complete decompression and
@@ -1134,8 +1156,6 @@ int unzOpenCurrentFile (unzFile file) {
     (UNZ_ERRNO for IO error, or zLib error for uncompress error)
 */
 int unzReadCurrentFile(unzFile file, voidp buf, unsigned len) {
-	int err=UNZ_OK;
-	uInt iRead = 0;
 	unz_s* s;
 	file_in_zip_read_info_s* pfile_in_zip_read_info;
 	if (file==NULL)
@@ -1146,6 +1166,16 @@ int unzReadCurrentFile(unzFile file, voidp buf, unsigned len) {
 	if (pfile_in_zip_read_info==NULL)
 		return UNZ_PARAMERROR;
 
+	return unzlocal_ReadCurrentFile(pfile_in_zip_read_info, buf, len);
+}
+
+/*
+  Read bytes from the file described by pfile_in_zip_read_info, see
+  unzReadCurrentFile
+*/
+static int unzlocal_ReadCurrentFile(file_in_zip_read_info_s* pfile_in_zip_read_info, voidp buf, unsigned len) {
+	int err=UNZ_OK;
+	uInt iRead = 0;
 
 	if (pfile_in_zip_read_info->read_buffer == NULL)
 		return UNZ_END_OF_LIST_OF_FILE;
@@ -1161,6 +1191,37 @@ int unzReadCurrentFile(unzFile file, voidp buf, unsigned len) {
 		  (uInt)pfile_in_zip_read_info->rest_read_uncompressed;
 
 	while (pfile_in_zip_read_info->stream.avail_out>0) {
+		if ((pfile_in_zip_read_info->compression_method==0) &&
+		    (pfile_in_zip_read_info->stream.avail_in==0) &&
+		    (pfile_in_zip_read_info->rest_read_compressed>0)) {
+			/* stored data needs no detour through read_buffer, it is read
+			   straight into buf */
+			uInt uReadThis = pfile_in_zip_read_info->stream.avail_out;
+			if (pfile_in_zip_read_info->rest_read_compressed<uReadThis)
+				uReadThis = (uInt)pfile_in_zip_read_info->rest_read_compressed;
+			pfile_in_zip_read_info->_stream->seek(pfile_in_zip_read_info->pos_in_zipfile +
+				pfile_in_zip_read_info->byte_before_the_zipfile, SEEK_SET);
+			if (pfile_in_zip_read_info->_stream->err())
+				return UNZ_ERRNO;
+			if (pfile_in_zip_read_info->_stream->read(pfile_in_zip_read_info->stream.next_out,uReadThis)!=uReadThis)
+				return UNZ_ERRNO;
+			pfile_in_zip_read_info->pos_in_zipfile += uReadThis;
+
+			pfile_in_zip_read_info->rest_read_compressed-=uReadThis;
+
+#ifdef USE_ZLIB
+			pfile_in_zip_read_info->crc32_data = crc32(pfile_in_zip_read_info->crc32_data,
+								pfile_in_zip_read_info->stream.next_out,
+								uReadThis);
+#endif
+			pfile_in_zip_read_info->rest_read_uncompressed-=uReadThis;
+			pfile_in_zip_read_info->stream.avail_out -= uReadThis;
+			pfile_in_zip_read_info->stream.next_out += uReadThis;
+			pfile_in_zip_read_info->stream.total_out += uReadThis;
+			iRead += uReadThis;
+			continue;
+		}
+
 		if ((pfile_in_zip_read_info->stream.avail_in==0) &&
 		    (pfile_in_zip_read_info->rest_read_compressed>0)) {
 			uInt uReadThis = UNZ_BUFSIZE;
@@ -1183,14 +1244,13 @@ int unzReadCurrentFile(unzFile file, voidp buf, unsigned len) {
 		}
 
 		if (pfile_in_zip_read_info->compression_method==0) {
-			uInt uDoCopy,i ;
+			uInt uDoCopy;
 			if (pfile_in_zip_read_info->stream.avail_out < pfile_in_zip_read_info->stream.avail_in)
 				uDoCopy = pfile_in_zip_read_info->stream.avail_out ;
 			else
 				uDoCopy = pfile_in_zip_read_info->stream.avail_in ;
 
-			for (i=0;i<uDoCopy;i++)
-				*(pfile_in_zip_read_info->stream.next_out+i) = *(pfile_in_zip_read_info->stream.next_in+i);
+			memcpy(pfile_in_zip_read_info->stream.next_out, pfile_in_zip_read_info->stream.next_in, uDoCopy);
 
 #ifdef USE_ZLIB
 			pfile_in_zip_read_info->crc32_data = crc32(pfile_in_zip_read_info->crc32_data,
@@ -1366,22 +1426,56 @@ int unzCloseCurrentFile(unzFile file) {
 		if (pfile_in_zip_read_info->crc32_data != pfile_in_zip_read_info->crc32_wait)
 			err=UNZ_CRCERROR;
 	}
-	if (pfile_in_zip_read_info->stream_initialised)
-		inflateEnd(&pfile_in_zip_read_info->stream);
 #endif
 
-
-	free(pfile_in_zip_read_info->read_buffer);
-	pfile_in_zip_read_info->read_buffer = NULL;
-
-	pfile_in_zip_read_info->stream_initialised = 0;
-	free(pfile_in_zip_read_info);
+	/* keep the structure for the next file, see unzOpenCurrentFile */
+	if (s->pfile_in_zip_read_cache == NULL)
+		s->pfile_in_zip_read_cache = pfile_in_zip_read_info;
+	else
+		unzlocal_FreeReadInfo(pfile_in_zip_read_info);
 
 	s->pfile_in_zip_read=NULL;
 
 	return err;
 }
 
+/*
+  Detach the file opened with unzOpenCurrentFile from the zipfile, and read
+  its data from the given stream from now on, which must contain the same
+  zipfile. This way, the file can be read independently of the zipfile and
+  of any other file in it.
+  The result must be freed with unzlocal_FreeReadInfo.
+*/
+static file_in_zip_read_info_s* unzlocal_DetachCurrentFile(unzFile file, Common::SeekableReadStream *stream) {
+	unz_s* s;
+	file_in_zip_read_info_s* pfile_in_zip_read_info;
+	if (file == NULL)
+		return NULL;
+	s = (unz_s*)file;
+	pfile_in_zip_read_info = s->pfile_in_zip_read;
+
+	if (pfile_in_zip_read_info == NULL)
+		return NULL;
+
+	pfile_in_zip_read_info->_stream = stream;
+	s->pfile_in_zip_read = NULL;
+
+	return pfile_in_zip_read_info;
+}
+
+/*
+  Free the structure about a file in the zipfile, including its inflate state
+*/
+static void unzlocal_FreeReadInfo(file_in_zip_read_info_s* pfile_in_zip_read_info) {
+#ifdef USE_ZLIB
+	if (pfile_in_zip_read_info->stream_initialised)
+		inflateEnd(&pfile_in_zip_read_info->stream);
+#endif
+
+	free(pfile_in_zip_read_info->read_buffer);
+	free(pfile_in_zip_read_info);
+}
+
 
 /*
   Get the global comment string of the ZipFile, in the szComment buffer.
@@ -1418,11 +1512,213 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 namespace Common {
 
 
+/**
+ * A read stream for a compressed file in a ZIP archive, which inflates the
+ * data as it is read, instead of all at once.
+ *
+ * It reads from a stream of its own on the ZIP archive, so it does not
+ * interfere with the archive or with other streams on its files.
+ * Inflated data cannot be seeked back to, so seeking back to the start
+ * restarts the decompression, and the first other backward seek inflates
+ * the whole file into memory, where it is read from after that.
+ */
+class ZipInflateReadStream : public SeekableReadStream {
+private:
+	SeekableReadStream *_zipStream;
+	file_in_zip_read_info_s *_info;
+	MemoryReadStream *_memoryStream;
+
+	const uLong _start;
+	const uLong _compressedSize;
+	const uint32 _size;
+
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+	void restart();
+	void inflateToMemory();
+
+public:
+	ZipInflateReadStream(SeekableReadStream *zipStream, file_in_zip_read_info_s *info) :
+		_zipStream(zipStream),
+		_info(info),
+		_memoryStream(0),
+		_start(info->pos_in_zipfile),
+		_compressedSize(info->rest_read_compressed),
+		_size(info->rest_read_uncompressed),
+		_pos(0),
+		_eos(false),
+		_err(false) {}
+
+	~ZipInflateReadStream() {
+		delete _memoryStream;
+		unzlocal_FreeReadInfo(_info);
+		delete _zipStream;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	bool eos() const { return _memoryStream ? _memoryStream->eos() : _eos; }
+	bool err() const { return _err; }
+	void clearErr() {
+		// Only reset the end of stream; decompression errors are not recoverable
+		_eos = false;
+		if (_memoryStream)
+			_memoryStream->clearErr();
+	}
+
+	int32 pos() const { return _memoryStream ? _memoryStream->pos() : _pos; }
+	int32 size() const { return _size; }
+
+	bool seek(int32 offset, int whence = SEEK_SET);
+};
+
+void ZipInflateReadStream::restart() {
+	_info->pos_in_zipfile = _start;
+	_info->rest_read_compressed = _compressedSize;
+	_info->rest_read_uncompressed = _size;
+	_info->crc32_data = 0;
+	_info->stream.avail_in = 0;
+	_info->stream.total_out = 0;
+#ifdef USE_ZLIB
+	if (_info->stream_initialised && inflateReset(&_info->stream) != Z_OK)
+		_err = true;
+#endif
+	_pos = 0;
+}
+
+void ZipInflateReadStream::inflateToMemory() {
+	restart();
+
+	byte *buffer = (byte *)malloc(_size);
+	assert(buffer);
+
+	if (read(buffer, _size) != _size)
+		_err = true;
+
+	_memoryStream = new MemoryReadStream(buffer, _size, DisposeAfterUse::YES);
+}
+
+uint32 ZipInflateReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (_memoryStream)
+		return _memoryStream->read(dataPtr, dataSize);
+
+	if (_err)
+		return 0;
+
+	const int result = unzlocal_ReadCurrentFile(_info, dataPtr, dataSize);
+	if (result < 0) {
+		_err = true;
+		return 0;
+	}
+
+	_pos += result;
+	if ((uint32)result < dataSize)
+		_eos = true;
+
+#ifdef USE_ZLIB
+	// Verify the checksum once everything has been inflated
+	if (_info->rest_read_uncompressed == 0 && _info->crc32_data != _info->crc32_wait)
+		_err = true;
+#endif
+
+	return result;
+}
+
+bool ZipInflateReadStream::seek(int32 offset, int whence) {
+	int32 newPos = offset;
+	if (whence == SEEK_CUR)
+		newPos += pos();
+	else if (whence == SEEK_END)
+		newPos += _size;
+
+	assert(newPos >= 0 && (uint32)newPos <= _size);
+
+	if (!_memoryStream && (uint32)newPos < _pos) {
+		if (newPos == 0)
+			restart();
+		else
+			inflateToMemory();
+	}
+
+	if (_memoryStream)
+		return _memoryStream->seek(newPos) && !_err;
+
+	// Skip the data up to the new position
+	byte tmpBuf[4096];
+	while (!_err && _pos < (uint32)newPos) {
+		if (!read(tmpBuf, MIN<uint32>(sizeof(tmpBuf), newPos - _pos)))
+			break;
+	}
+
+	_eos = false;
+	return !_err;
+}
+
+
+/**
+ * A read stream for a stored file in a ZIP archive, which reads the data in
+ * place from a stream of its own on the ZIP archive.
+ *
+ * The checksum is computed over the data read in order from the start of
+ * the file, and verified once the end is reached that way. Data skipped by
+ * seeking ahead is not read, so the checksum is only verified after reading
+ * on from where the verified data ends.
+ */
+class ZipStoredReadStream : public SeekableSubReadStream {
+private:
+	const uLong _crc;
+	uLong _crcData;
+	uint32 _crcSize;
+	bool _err;
+
+public:
+	ZipStoredReadStream(SeekableReadStream *zipStream, uint32 begin, uint32 end, uLong crc) :
+		SeekableSubReadStream(zipStream, begin, end, DisposeAfterUse::YES),
+		_crc(crc),
+		_crcData(0),
+		_crcSize(0),
+		_err(false) {}
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	// Checksum errors are not recoverable, so clearErr() keeps them
+	bool err() const { return _err || SeekableSubReadStream::err(); }
+};
+
+uint32 ZipStoredReadStream::read(void *dataPtr, uint32 dataSize) {
+	const uint32 start = pos();
+	const uint32 result = SeekableSubReadStream::read(dataPtr, dataSize);
+
+#ifdef USE_ZLIB
+	if (start == _crcSize && result > 0) {
+		_crcData = crc32(_crcData, (const Bytef *)dataPtr, result);
+		_crcSize += result;
+		if (_crcSize == (uint32)size() && _crcData != _crc)
+			_err = true;
+	}
+#endif
+
+	return result;
+}
+
 class ZipArchive : public Archive {
 	unzFile _zipFile;
 
+	/**
+	 * The ZIP archive itself, if it can be opened again. This is used to
+	 * give large files their own stream on the archive.
+	 */
+	ArchiveMemberPtr _source;
+
+	enum {
+		/** Files at least this large are streamed, if possible */
+		kStreamedFileSize = 1024 * 1024
+	};
+
 public:
-	ZipArchive(unzFile zipFile);
+	ZipArchive(unzFile zipFile, ArchiveMemberPtr source);
 
 
 	~ZipArchive();
@@ -1451,7 +1747,7 @@ public:
 };
 */
 
-ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
+ZipArchive::ZipArchive(unzFile zipFile, ArchiveMemberPtr source) : _zipFile(zipFile), _source(source) {
 	assert(_zipFile);
 }
 
@@ -1500,6 +1796,25 @@ Common::SeekableReadStream *ZipArchive::createReadStreamForMember(const Common::
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
 		return 0;
 
+	// Large files are not read into memory at once, but read as needed from
+	// a stream of their own on the archive, if it can be opened again
+	if (fileInfo.uncompressed_size >= kStreamedFileSize && _source) {
+		SeekableReadStream *zipStream = _source->createReadStream();
+		if (zipStream) {
+			file_in_zip_read_info_s *info = unzlocal_DetachCurrentFile(_zipFile, zipStream);
+			assert(info);
+
+			if (info->compression_method != 0)
+				return new ZipInflateReadStream(zipStream, info);
+
+			// Stored files can simply be read in place
+			const uint32 begin = info->pos_in_zipfile + info->byte_before_the_zipfile;
+			const uLong crc = info->crc32_wait;
+			unzlocal_FreeReadInfo(info);
+			return new ZipStoredReadStream(zipStream, begin, begin + fileInfo.uncompressed_size, crc);
+		}
+	}
+
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
 	assert(buffer);
 
@@ -1514,22 +1829,9 @@ Common::SeekableReadStream *ZipArchive::createReadStreamForMember(const Common::
 	}
 
 	return new Common::MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
-}
-
-Archive *makeZipArchive(const String &name) {
-	return makeZipArchive(SearchMan.createReadStreamForMember(name));
 }
 
-Archive *makeZipArchive(const FSNode &node) {
-	return makeZipArchive(node.createReadStream());
-}
-
-Archive *makeZipArchive(SeekableReadStream *stream) {
+static Archive *openZipArchive(SeekableReadStream *stream, ArchiveMemberPtr source) {
 	if (!stream)
 		return 0;
 	unzFile zipFile = unzOpen(stream);
@@ -1538,7 +1840,24 @@ Archive *makeZipArchive(SeekableReadStream *stream) {
 		// goes wrong.
 		return 0;
 	}
-	return new ZipArchive(zipFile);
+	return new ZipArchive(zipFile, source);
+}
+
+Archive *makeZipArchive(const String &name) {
+	return makeZipArchive(name, SearchMan);
+}
+
+Archive *makeZipArchive(const String &name, Archive &archive) {
+	return openZipArchive(archive.createReadStreamForMember(name), ArchiveMemberPtr(new GenericArchiveMember(name, &archive)));
+}
+
+Archive *makeZipArchive(const FSNode &node) {
+	return openZipArchive(node.createReadStream(), ArchiveMemberPtr(new FSNode(node)));
+}
+
+Archive *makeZipArchive(SeekableReadStream *stream) {
+	// There is no way to open the stream again, so files are never streamed
+	return openZipArchive(stream, ArchiveMemberPtr());
 }
 
 }	// End of namespace Common
@@ -41,6 +41,15 @@ class SeekableReadStream;
  */
 Archive *makeZipArchive(const String &name);
 
+/**
+ * This factory method creates an Archive instance corresponding to the content
+ * of the ZIP compressed file with the given name in the given archive, which
+ * has to exist as long as the ZipArchive.
+ *
+ * May return 0 in case of a failure.
+ */
+Archive *makeZipArchive(const String &name, Archive &archive);
+
 /**
  * This factory method creates an Archive instance corresponding to the content
  * of the ZIP compressed file with the given name.
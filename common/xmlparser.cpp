@@ -30,6 +30,38 @@
 
 namespace Common {
 
+// Compiled data starts with this tag and holds one record per key event:
+// kCompiledKeyOpen followed by the key name, the number of properties and
+// each property name and value, or kCompiledKeyClose. Strings are stored
+// with a 16 bit length. kCompiledEnd ends the data.
+static const uint32 kCompiledTag = MKTAG('X','M','L','C');
+
+enum {
+	kCompiledEnd = 0,
+	kCompiledKeyOpen = 1,
+	kCompiledKeyClose = 2
+};
+
+static void writeCompiledString(WriteStream *stream, const String &str) {
+	assert(str.size() <= 0xFFFF);
+	stream->writeUint16LE(str.size());
+	stream->write(str.c_str(), str.size());
+}
+
+static bool readCompiledString(SeekableReadStream *stream, String &str) {
+	char buffer[256];
+	const uint16 size = stream->readUint16LE();
+	char *data = (size <= sizeof(buffer)) ? buffer : new char[size];
+
+	const bool ok = (stream->read(data, size) == size);
+	if (ok)
+		str = String(data, size);
+
+	if (data != buffer)
+		delete[] data;
+	return ok;
+}
+
 XMLParser::~XMLParser() {
 	while (!_activeKey.empty())
 		freeNode(_activeKey.pop());
@@ -82,6 +114,19 @@ void XMLParser::close() {
 bool XMLParser::parserError(const char *errorString, ...) {
 	_state = kParserError;
 
+	// There is no source text to show for compiled data
+	if (_compiledInput) {
+		fprintf(stderr, "\n  File <%s> (compiled)\n\nParser error: ", _fileName.c_str());
+
+		va_list args;
+		va_start(args, errorString);
+		vfprintf(stderr, errorString, args);
+		va_end(args);
+
+		fprintf(stderr, "\n\n");
+		return false;
+	}
+
 	const int startPosition = _stream->pos();
 	int currentPosition = startPosition;
 	int lineCount = 1;
@@ -189,6 +234,16 @@ bool XMLParser::parseActiveKey(bool closed) {
 		return parserError("Unexpected key in the active scope ('%s').", key->name.c_str());
 	}
 
+	if (_compiledOutput && !_compiledInput) {
+		_compiledOutput->writeByte(kCompiledKeyOpen);
+		writeCompiledString(_compiledOutput, key->name);
+		_compiledOutput->writeByte(key->values.size());
+		for (StringMap::const_iterator i = key->values.begin(); i != key->values.end(); ++i) {
+			writeCompiledString(_compiledOutput, i->_key);
+			writeCompiledString(_compiledOutput, i->_value);
+		}
+	}
+
 	// check if any of the parents must be ignored.
 	// if a parent is ignored, all children are too.
 	for (int i = _activeKey.size() - 1; i >= 0; --i) {
@@ -296,6 +351,9 @@ bool XMLParser::closeKey() {
 	if (ignore == false)
 		result = closedKeyCallback(_activeKey.top());
 
+	if (_compiledOutput && !_compiledInput && !_activeKey.top()->header)
+		_compiledOutput->writeByte(kCompiledKeyClose);
+
 	freeNode(_activeKey.pop());
 
 	return result;
@@ -316,6 +374,10 @@ bool XMLParser::parse() {
 
 	cleanup();
 
+	_compiledInput = false;
+	if (_compiledOutput)
+		_compiledOutput->writeUint32BE(kCompiledTag);
+
 	bool activeClosure = false;
 	bool activeHeader = false;
 	bool selfClosure;
@@ -462,9 +524,77 @@ bool XMLParser::parse() {
 	if (_state != kParserNeedKey || !_activeKey.empty())
 		return parserError("Unexpected end of file.");
 
+	if (_compiledOutput)
+		_compiledOutput->writeByte(kCompiledEnd);
+
 	return true;
 }
 
+bool XMLParser::parseCompiled() {
+	if (_stream == 0)
+		return parserError("XML stream not ready for reading.");
+
+	_stream->seek(0, SEEK_SET);
+
+	if (_XMLkeys == 0)
+		buildLayout();
+
+	while (!_activeKey.empty())
+		freeNode(_activeKey.pop());
+
+	cleanup();
+
+	_compiledInput = true;
+	_state = kParserNeedKey;
+
+	if (_stream->readUint32BE() != kCompiledTag)
+		return parserError("Invalid compiled XML data.");
+
+	bool result = false;
+
+	while (_state != kParserError) {
+		const byte record = _stream->readByte();
+
+		if (_stream->err() || _stream->eos()) {
+			parserError("Unexpected end of file.");
+		} else if (record == kCompiledKeyOpen) {
+			ParserNode *node = allocNode();
+			node->ignore = false;
+			node->header = false;
+			node->depth = _activeKey.size();
+			node->layout = 0;
+			_activeKey.push(node);
+
+			bool ok = readCompiledString(_stream, node->name);
+			for (int count = _stream->readByte(); ok && count > 0; --count) {
+				String name;
+				ok = readCompiledString(_stream, name) && readCompiledString(_stream, node->values[name]);
+			}
+
+			if (!ok)
+				parserError("Unexpected end of file.");
+			else
+				parseActiveKey(false);
+		} else if (record == kCompiledKeyClose) {
+			if (_activeKey.empty()) {
+				parserError("Unexpected closure.");
+			} else {
+				const String name = _activeKey.top()->name;
+				if (!closeKey())
+					parserError("Missing data when closing key '%s'.", name.c_str());
+			}
+		} else if (record == kCompiledEnd && _activeKey.empty()) {
+			result = true;
+			break;
+		} else {
+			parserError("Invalid compiled XML data.");
+		}
+	}
+
+	_compiledInput = false;
+	return result;
+}
+
 bool XMLParser::skipSpaces() {
 	if (!isspace(_char))
 		return false;
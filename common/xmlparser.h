@@ -39,6 +39,7 @@
 namespace Common {
 
 class SeekableReadStream;
+class WriteStream;
 
 #define MAX_XML_DEPTH 8
 
@@ -94,7 +95,7 @@ public:
 	/**
 	 * Parser constructor.
 	 */
-	XMLParser() : _XMLkeys(0), _stream(0) {}
+	XMLParser() : _XMLkeys(0), _stream(0), _compiledOutput(0), _compiledInput(false) {}
 
 	virtual ~XMLParser();
 
@@ -189,6 +190,26 @@ public:
 	 */
 	bool parse();
 
+	/**
+	 * Sets a stream to which parse() writes the keys it reads, in a
+	 * compact binary form. Once parse() succeeded, the data can be loaded
+	 * back into the parser and passed to parseCompiled(), which issues the
+	 * same callbacks without tokenizing the XML again. Only syntax is
+	 * resolved at this point: keys which a callback ignores are kept,
+	 * so the result does not depend on the state of the parser.
+	 *
+	 * @param stream Stream to write to, or 0 to stop writing.
+	 */
+	void setCompiledOutput(WriteStream *stream) {
+		_compiledOutput = stream;
+	}
+
+	/**
+	 * Parses the loaded data stream, which must have been produced by
+	 * parse() through setCompiledOutput(). Returns true if successful.
+	 */
+	bool parseCompiled();
+
 	/**
 	 * Returns the active node being parsed (the one on top of
 	 * the node stack).
@@ -343,6 +364,9 @@ private:
 	SeekableReadStream *_stream;
 	String _fileName;
 
+	WriteStream *_compiledOutput; /** Receives the parsed keys, if set */
+	bool _compiledInput; /** Set while parsing compiled data */
+
 	ParserState _state; /** Internal state of the parser */
 
 	String _error; /** Current error message */
@@ -26,10 +26,11 @@
 #include "common/debug.h"
 #include "common/util.h"
 #include "common/hash-str.h"
-#include "common/file.h"
 #include "common/macresman.h"
-#include "common/md5.h"
+#include "common/str-array.h"
+#include "common/md5cache.h"
 #include "common/config-manager.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 
 #include "engines/advancedDetector.h"
@@ -39,6 +40,67 @@
  */
 typedef Common::Array<const ADGameDescription*> ADGameDescList;
 
+/**
+ * For every file name used by the game descriptions of an engine, the
+ * descriptions listing that file.
+ */
+struct ADFileIndex {
+	struct FileEntry {
+		bool resForkFirst;	///< The first description using the file reads it from a resource fork
+		bool hasResFork;	///< Some description reads the file from a resource fork
+		bool hasPlain;		///< Some description reads the file as a regular file
+		Common::Array<uint> descs;	///< Indices of the descriptions using the file, in table order
+	};
+
+	typedef Common::HashMap<Common::String, FileEntry, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileEntryMap;
+
+	FileEntryMap files;
+	Common::StringArray resForkFiles;	///< Files which may have to be opened with a resource fork
+	Common::Array<uint> numFiles;		///< Number of distinct files of every description
+
+	ADFileIndex(const ADParams &params);
+
+	const ADGameDescription *getDesc(const ADParams &params, uint i) const {
+		return (const ADGameDescription *)(params.descs + i * params.descItemSize);
+	}
+};
+
+ADFileIndex::ADFileIndex(const ADParams &params) {
+	const byte *descPtr;
+	uint i;
+
+	for (i = 0, descPtr = params.descs; ((const ADGameDescription *)descPtr)->gameid != 0; descPtr += params.descItemSize, ++i) {
+		const ADGameDescription *g = (const ADGameDescription *)descPtr;
+		const bool resFork = (g->flags & ADGF_MACRESFORK) != 0;
+		uint count = 0;
+
+		for (const ADGameFileDescription *fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
+			FileEntryMap::iterator entry = files.find(fileDesc->fileName);
+			if (entry == files.end()) {
+				FileEntry &e = files[fileDesc->fileName];
+				e.resForkFirst = resFork;
+				e.hasResFork = false;
+				e.hasPlain = false;
+				entry = files.find(fileDesc->fileName);
+			}
+
+			FileEntry &e = entry->_value;
+			if (resFork && !e.hasResFork)
+				resForkFiles.push_back(fileDesc->fileName);
+			e.hasResFork |= resFork;
+			e.hasPlain |= !resFork;
+
+			// Descriptions listing the same file twice only count it once
+			if (e.descs.empty() || e.descs.back() != i) {
+				e.descs.push_back(i);
+				count++;
+			}
+		}
+
+		numFiles.push_back(count);
+	}
+}
+
 
 /**
  * Detect games in specified directory.
@@ -52,7 +114,7 @@ typedef Common::Array<const ADGameDescription*> ADGameDescList;
  * @param platform	restrict results to specified platform only
  * @return	list of ADGameDescription (or subclass) pointers corresponding to matched games
  */
-static ADGameDescList detectGame(const Common::FSList &fslist, const ADParams &params, Common::Language language, Common::Platform platform, const Common::String &extra);
+static ADGameDescList detectGame(const Common::FSList &fslist, const ADParams &params, const ADFileIndex &index, Common::Language language, Common::Platform platform, const Common::String &extra);
 
 
 /**
@@ -236,8 +298,16 @@ bool cleanupPirated(ADGameDescList &matched) {
 }
 
 
+AdvancedMetaEngine::AdvancedMetaEngine(const ADParams &dp) : params(dp) {
+	_fileIndex = new ADFileIndex(params);
+}
+
+AdvancedMetaEngine::~AdvancedMetaEngine() {
+	delete _fileIndex;
+}
+
 GameList AdvancedMetaEngine::detectGames(const Common::FSList &fslist) const {
-	ADGameDescList matches = detectGame(fslist, params, Common::UNK_LANG, Common::kPlatformUnknown, "");
+	ADGameDescList matches = detectGame(fslist, params, *_fileIndex, Common::UNK_LANG, Common::kPlatformUnknown, "");
 	GameList detectedGames;
 
 	if (cleanupPirated(matches))
@@ -308,7 +378,7 @@ Common::Error AdvancedMetaEngine::createInstance(OSystem *syst, Engine **engine)
 		return Common::kNoGameDataFoundError;
 	}
 
-	ADGameDescList matches = detectGame(files, params, language, platform, extra);
+	ADGameDescList matches = detectGame(files, params, *_fileIndex, language, platform, extra);
 
 	if (cleanupPirated(matches))
 		return Common::kNoGameDataFoundError;
@@ -422,77 +492,100 @@ static void composeFileHashMap(const Common::FSList &fslist, FileMap &allFiles,
 	}
 }
 
-static ADGameDescList detectGame(const Common::FSList &fslist, const ADParams &params, Common::Language language, Common::Platform platform, const Common::String &extra) {
+static void hashFile(const Common::String &fname, const ADParams &params, const Common::FSNode &parent, const FileMap &allFiles, bool resFork, SizeMD5Map &filesSizeMD5) {
+	SizeMD5 tmp;
+
+	if (resFork) {
+		Common::MacResManager *macResMan = new Common::MacResManager();
+
+		if (macResMan->open(parent, fname)) {
+			tmp.md5 = macResMan->computeResForkMD5AsString(params.md5Bytes);
+			tmp.size = macResMan->getResForkDataSize();
+			debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
+			filesSizeMD5[fname] = tmp;
+		}
+
+		delete macResMan;
+	} else {
+		FileMap::const_iterator file = allFiles.find(fname);
+		if (file != allFiles.end()) {
+			debug(3, "+ %s", fname.c_str());
+
+			tmp.md5 = MD5Man.computeFileMD5AsString(file->_value, params.md5Bytes, tmp.size);
+
+			debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
+			filesSizeMD5[fname] = tmp;
+		}
+	}
+}
+
+static ADGameDescList detectGame(const Common::FSList &fslist, const ADParams &params, const ADFileIndex &index, Common::Language language, Common::Platform platform, const Common::String &extra) {
 	FileMap allFiles;
 	SizeMD5Map filesSizeMD5;
 
 	const ADGameFileDescription *fileDesc;
 	const ADGameDescription *g;
-	const byte *descPtr;
 
 	if (fslist.empty())
 		return ADGameDescList();
 	Common::FSNode parent = fslist.begin()->getParent();
 	debug(3, "Starting detection in dir '%s'", parent.getPath().c_str());
 
+	const uint32 startTime = g_system->getMillis();
+
 	// First we compose a hashmap of all files in fslist.
 	// Includes nifty stuff like removing trailing dots and ignoring case.
 	composeFileHashMap(fslist, allFiles, (params.depth == 0 ? 1 : params.depth), params.directoryGlobs);
 
 	// Check which files are included in some ADGameDescription *and* present
-	// in fslist. Compute MD5s and file sizes for these files.
-	for (descPtr = params.descs; ((const ADGameDescription *)descPtr)->gameid != 0; descPtr += params.descItemSize) {
-		g = (const ADGameDescription *)descPtr;
-
-		for (fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
-			Common::String fname = fileDesc->fileName;
-			SizeMD5 tmp;
-
-			if (filesSizeMD5.contains(fname))
-				continue;
-
-			// FIXME/TODO: We don't handle the case that a file is listed as a regular
-			// file and as one with resource fork.
-
-			if (g->flags & ADGF_MACRESFORK) {
-				Common::MacResManager *macResMan = new Common::MacResManager();
-
-				if (macResMan->open(parent, fname)) {
-					tmp.md5 = macResMan->computeResForkMD5AsString(params.md5Bytes);
-					tmp.size = macResMan->getResForkDataSize();
-					debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
-					filesSizeMD5[fname] = tmp;
-				}
-
-				delete macResMan;
-			} else {
-				if (allFiles.contains(fname)) {
-					debug(3, "+ %s", fname.c_str());
+	// in fslist. Compute MD5s and file sizes for these files. A file is read
+	// the way the first description listing it wants it, and the other way
+	// if that fails.
+	for (FileMap::const_iterator file = allFiles.begin(); file != allFiles.end(); ++file) {
+		ADFileIndex::FileEntryMap::const_iterator entry = index.files.find(file->_key);
+		if (entry != index.files.end() && !entry->_value.resForkFirst)
+			hashFile(entry->_key, params, parent, allFiles, false, filesSizeMD5);
+	}
 
-					Common::File testFile;
+	// Files with resource forks need not show up in fslist under their
+	// own name, so these have to be tried one by one.
+	for (Common::StringArray::const_iterator fname = index.resForkFiles.begin(); fname != index.resForkFiles.end(); ++fname) {
+		if (filesSizeMD5.contains(*fname))
+			continue;
 
-					if (testFile.open(allFiles[fname])) {
-						tmp.size = (int32)testFile.size();
-						tmp.md5 = Common::computeStreamMD5AsString(testFile, params.md5Bytes);
-					} else {
-						tmp.size = -1;
-					}
+		// FIXME/TODO: We don't handle the case that a file is listed as a regular
+		// file and as one with resource fork.
+		const ADFileIndex::FileEntry &entry = index.files[*fname];
+		hashFile(*fname, params, parent, allFiles, true, filesSizeMD5);
+		if (entry.resForkFirst && entry.hasPlain && !filesSizeMD5.contains(*fname))
+			hashFile(*fname, params, parent, allFiles, false, filesSizeMD5);
+	}
 
-					debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
-					filesSizeMD5[fname] = tmp;
-				}
-			}
-		}
+	// Only descriptions with all their files present can match or cause an
+	// unknown game report, so count the present files of every description.
+	Common::Array<uint> present;
+	present.resize(index.numFiles.size());
+	for (uint i = 0; i < present.size(); ++i)
+		present[i] = 0;
+	for (SizeMD5Map::const_iterator file = filesSizeMD5.begin(); file != filesSizeMD5.end(); ++file) {
+		const Common::Array<uint> &descs = index.files[file->_key].descs;
+		for (uint i = 0; i < descs.size(); ++i)
+			present[descs[i]]++;
 	}
 
 	ADGameDescList matched;
 	int maxFilesMatched = 0;
 	bool gotAnyMatchesWithAllFiles = false;
+	uint descsChecked = 0;
 
 	// MD5 based matching
 	uint i;
-	for (i = 0, descPtr = params.descs; ((const ADGameDescription *)descPtr)->gameid != 0; descPtr += params.descItemSize, ++i) {
-		g = (const ADGameDescription *)descPtr;
+	for (i = 0; i < present.size(); ++i) {
+		if (present[i] != index.numFiles[i])
+			continue;
+
+		g = index.getDesc(params, i);
+		descsChecked++;
 		bool fileMissing = false;
 
 		// Do not even bother to look at entries which do not have matching
@@ -580,6 +673,9 @@ static ADGameDescList detectGame(const Common::FSList &fslist, const ADParams &p
 			matched = detectGameFilebased(allFiles, params);
 	}
 
+	debug(2, "Checked %d of %d game descriptions, hashed %d files in %d ms", descsChecked, present.size(),
+		filesSizeMD5.size(), g_system->getMillis() - startTime);
+
 	return matched;
 }
 
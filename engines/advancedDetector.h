@@ -228,13 +228,23 @@ GameDescriptor findGameID(
 
 } // End of namespace AdvancedDetector
 
+struct ADFileIndex;
+
 /**
  * A MetaEngine implementation based around the advanced detector code.
  */
 class AdvancedMetaEngine : public MetaEngine {
 	const ADParams &params;
+
+	/**
+	 * Maps the file names used by the game descriptions to the descriptions
+	 * using them. Built once when the engine is loaded, so that detection
+	 * only has to look at descriptions whose files are all present.
+	 */
+	ADFileIndex *_fileIndex;
 public:
-	AdvancedMetaEngine(const ADParams &dp) : params(dp) {}
+	AdvancedMetaEngine(const ADParams &dp);
+	virtual ~AdvancedMetaEngine();
 
 	virtual GameList getSupportedGames() const;
 	virtual GameDescriptor findGame(const char *gameid) const;
@@ -36,6 +36,10 @@
 #include "scumm/object.h"
 #include "scumm/scumm.h"
 #include "scumm/sound.h"
+#ifdef ENABLE_SCUMM_7_8
+#include "scumm/scumm_v7.h"
+#include "scumm/smush/smush_player.h"
+#endif
 
 namespace Scumm {
 
@@ -99,6 +103,11 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 
 	DCmd_Register("imuse",     WRAP_METHOD(ScummDebugger, Cmd_IMuse));
 
+#ifdef ENABLE_SCUMM_7_8
+	if (_vm->_game.version >= 7)
+		DCmd_Register("smushbench", WRAP_METHOD(ScummDebugger, Cmd_SmushBenchmark));
+#endif
+
 	DCmd_Register("resetcursors",    WRAP_METHOD(ScummDebugger, Cmd_ResetCursors));
 }
 
@@ -117,6 +126,42 @@ bool ScummDebugger::Cmd_Restart(int argc, const char **argv) {
 	return false;
 }
 
+#ifdef ENABLE_SCUMM_7_8
+bool ScummDebugger::Cmd_SmushBenchmark(int argc, const char **argv) {
+	if (argc != 2) {
+		DebugPrintf("Usage: %s <file.san>\n", argv[0]);
+		return true;
+	}
+
+	ScummEngine_v7 *vm = (ScummEngine_v7 *)_vm;
+	if (vm->isSmushActive()) {
+		DebugPrintf("Cannot benchmark while a SMUSH video is playing\n");
+		return true;
+	}
+
+	SmushPlayer::BenchmarkStats stats;
+	if (!vm->_splayer->benchmark(argv[1], stats)) {
+		DebugPrintf("Could not open SMUSH file '%s'\n", argv[1]);
+		return true;
+	}
+
+	DebugPrintf("%d frames in %d ms", stats.frames, stats.totalTime);
+	if (stats.totalTime)
+		DebugPrintf(" (%d frames/sec)", stats.frames * 1000 / stats.totalTime);
+	DebugPrintf("\n");
+
+	for (uint i = 0; i < stats.codecs.size(); i++) {
+		const SmushPlayer::CodecStats &codec = stats.codecs[i];
+		DebugPrintf("  codec %2d: %5d objects, %5d ms decoding", codec.codec, codec.objects, codec.decodeTime);
+		if (codec.decodeTime)
+			DebugPrintf(" (%d objects/sec)", codec.objects * 1000 / codec.decodeTime);
+		DebugPrintf("\n");
+	}
+
+	return true;
+}
+#endif
+
 bool ScummDebugger::Cmd_IMuse(int argc, const char **argv) {
 	if (!_vm->_imuse && !_vm->_musicEngine) {
 		DebugPrintf("No iMuse engine is active.\n");
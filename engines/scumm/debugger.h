@@ -67,6 +67,9 @@ private:
 	bool Cmd_Hide(int argc, const char **argv);
 
 	bool Cmd_IMuse(int argc, const char **argv);
+#ifdef ENABLE_SCUMM_7_8
+	bool Cmd_SmushBenchmark(int argc, const char **argv);
+#endif
 
 	bool Cmd_ResetCursors(int argc, const char **argv);
 
@@ -30,6 +30,10 @@
 #include "scumm/bomp.h"
 #include "scumm/smush/codec47.h"
 
+#if defined(__SSE2__) && !defined(SCUMM_NEED_ALIGNMENT)
+#include <emmintrin.h>
+#endif
+
 namespace Scumm {
 
 #if defined(SCUMM_NEED_ALIGNMENT)
@@ -73,6 +77,43 @@ namespace Scumm {
 		(dst)[1] = val;	\
 	} while (0)
 
+// Lines of 8x8 blocks are the most common case. Where available, they are
+// moved with a single 64 bit vector load/store. FILL_8X1_LINE takes a value
+// prepared by MAKE_FILL_8X1 outside of the loop.
+#if defined(__SSE2__) && !defined(SCUMM_NEED_ALIGNMENT)
+
+typedef __m128i Fill8X1;
+
+#define MAKE_FILL_8X1(val)			\
+	_mm_set1_epi8((char)(val))
+
+#define COPY_8X1_LINE(dst, src)			\
+	_mm_storel_epi64((__m128i *)(dst), _mm_loadl_epi64((const __m128i *)(src)))
+
+#define FILL_8X1_LINE(dst, val8)		\
+	_mm_storel_epi64((__m128i *)(dst), val8)
+
+#else
+
+typedef byte Fill8X1;
+
+#define MAKE_FILL_8X1(val)			\
+	(val)
+
+#define COPY_8X1_LINE(dst, src)			\
+	do {					\
+		COPY_4X1_LINE(dst, src);	\
+		COPY_4X1_LINE((dst) + 4, (src) + 4);	\
+	} while (0)
+
+#define FILL_8X1_LINE(dst, val8)		\
+	do {					\
+		FILL_4X1_LINE(dst, val8);	\
+		FILL_4X1_LINE((dst) + 4, val8);	\
+	} while (0)
+
+#endif
+
 static const  int8 codec47_table_small1[] = {
   0, 1, 2, 3, 3, 3, 3, 2, 1, 0, 0, 0, 1, 2, 2, 1,
 };
@@ -454,8 +495,7 @@ void Codec47Decoder::level1(byte *d_dst) {
 	if (code < 0xF8) {
 		tmp2 = _table[code] + _offset1;
 		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst + 0, d_dst + tmp2);
-			COPY_4X1_LINE(d_dst + 4, d_dst + tmp2 + 4);
+			COPY_8X1_LINE(d_dst, d_dst + tmp2);
 			d_dst += _d_pitch;
 		}
 	} else if (code == 0xFF) {
@@ -468,9 +508,9 @@ void Codec47Decoder::level1(byte *d_dst) {
 		level2(d_dst);
 	} else if (code == 0xFE) {
 		byte t = *_d_src++;
+		Fill8X1 t8 = MAKE_FILL_8X1(t);
 		for (i = 0; i < 8; i++) {
-			FILL_4X1_LINE(d_dst, t);
-			FILL_4X1_LINE(d_dst + 4, t);
+			FILL_8X1_LINE(d_dst, t8);
 			d_dst += _d_pitch;
 		}
 	} else if (code == 0xFD) {
@@ -493,15 +533,14 @@ void Codec47Decoder::level1(byte *d_dst) {
 	} else if (code == 0xFC) {
 		tmp2 = _offset2;
 		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst + 0, d_dst + tmp2);
-			COPY_4X1_LINE(d_dst + 4, d_dst + tmp2 + 4);
+			COPY_8X1_LINE(d_dst, d_dst + tmp2);
 			d_dst += _d_pitch;
 		}
 	} else {
 		byte t = _paramPtr[code];
+		Fill8X1 t8 = MAKE_FILL_8X1(t);
 		for (i = 0; i < 8; i++) {
-			FILL_4X1_LINE(d_dst, t);
-			FILL_4X1_LINE(d_dst + 4, t);
+			FILL_8X1_LINE(d_dst, t8);
 			d_dst += _d_pitch;
 		}
 	}
@@ -27,6 +27,7 @@
 
 #include "common/config-manager.h"
 #include "common/file.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "common/util.h"
 
@@ -244,9 +245,14 @@ SmushPlayer::SmushPlayer(ScummEngine_v7 *scumm) {
 	_paused = false;
 	_pauseStartTime = 0;
 	_pauseTime = 0;
+	_chunkQueueMaxDepth = 0;
+	_queueHits = 0;
+	_queueMisses = 0;
+	_lateFrames = 0;
 }
 
 SmushPlayer::~SmushPlayer() {
+	clearChunkQueue();
 }
 
 void SmushPlayer::init(int32 speed) {
@@ -282,6 +288,10 @@ void SmushPlayer::init(int32 speed) {
 void SmushPlayer::release() {
 	_vm->_smushVideoShouldFinish = true;
 
+	debugC(DEBUG_SMUSH, "Smush stats: %d frames read ahead, %d read on demand, max queue depth %d, %d late frames",
+			_queueHits, _queueMisses, _chunkQueueMaxDepth, _lateFrames);
+	clearChunkQueue();
+
 	for (int i = 0; i < 5; i++) {
 		delete _sf[i];
 		_sf[i] = NULL;
@@ -975,6 +985,9 @@ void SmushPlayer::parseNextFrame() {
 		if (_smixer)
 			_smixer->stop();
 
+		// Chunks read ahead from the old position are useless now
+		clearChunkQueue();
+
 		if (_seekFile.size() > 0) {
 			delete _base;
 
@@ -1017,35 +1030,219 @@ void SmushPlayer::parseNextFrame() {
 
 	assert(_base);
 
-	const uint32 subType = _base->readUint32BE();
-	const int32 subSize = _base->readUint32BE();
-	const int32 subOffset = _base->pos();
+	if (!_chunkQueue.empty()) {
+		// The chunk has already been read ahead
+		QueuedChunk chunk = _chunkQueue.pop();
+		Common::MemoryReadStream stream(chunk.data, chunk.size, DisposeAfterUse::YES);
+		_queueHits++;
 
-	if (_base->pos() >= (int32)_baseSize) {
-		_vm->_smushVideoShouldFinish = true;
-		_endOfFile = true;
-		return;
+		handleChunk(chunk.type, chunk.size, chunk.offset, stream);
+	} else {
+		const uint32 subType = _base->readUint32BE();
+		const int32 subSize = _base->readUint32BE();
+		const int32 subOffset = _base->pos();
+
+		if (_base->pos() >= (int32)_baseSize) {
+			_vm->_smushVideoShouldFinish = true;
+			_endOfFile = true;
+			return;
+		}
+		_queueMisses++;
+
+		handleChunk(subType, subSize, subOffset, *_base);
+
+		_base->seek(subOffset + subSize, SEEK_SET);
 	}
 
-	debug(3, "Chunk: %s at %x", tag2str(subType), subOffset);
+	if (_insanity)
+		_vm->_sound->processSound();
+
+	_vm->_imuseDigital->flushTracks();
+}
+
+bool SmushPlayer::benchmark(const char *filename, BenchmarkStats &stats) {
+	ScummFile file;
+	if (!_vm->openFile(file, filename) || file.readUint32BE() != MKTAG('A','N','I','M'))
+		return false;
+	const uint32 fileSize = file.readUint32BE() + 8;
+
+	stats.frames = 0;
+	stats.totalTime = 0;
+	stats.codecs.clear();
+
+	// Use private decoders, so that the state of the player is not touched
+	Codec37Decoder *codec37 = 0;
+	Codec47Decoder *codec47 = 0;
+	byte *dst = 0;
+	int dstSize = 0;
+
+	const uint32 startTime = _vm->_system->getMillis();
+
+	while ((uint32)file.pos() + 8 <= fileSize && !file.eos()) {
+		const uint32 type = file.readUint32BE();
+		const int32 size = file.readUint32BE();
+		const int32 offset = file.pos();
+		if (size < 0)
+			break;
 
-	switch (subType) {
+		if (type == MKTAG('F','R','M','E')) {
+			stats.frames++;
+
+			int32 frameSize = size;
+			while (frameSize >= 8) {
+				const uint32 subType = file.readUint32BE();
+				const int32 subSize = file.readUint32BE();
+				const int32 subOffset = file.pos();
+
+				// The rest of the frame can not be trusted after a chunk
+				// which does not fit into it
+				if (file.eos() || subSize < 0 || subSize > frameSize - 8) {
+					warning("SmushPlayer::benchmark() Broken chunk in frame %d", stats.frames);
+					break;
+				}
+
+				// Object chunks start with a 14 byte header
+				byte *chunk = 0;
+				if (subType == MKTAG('F','O','B','J') && subSize >= 14) {
+					chunk = (byte *)malloc(subSize);
+					if (file.read(chunk, subSize) != (uint32)subSize) {
+						free(chunk);
+						chunk = 0;
+					}
+#ifdef USE_ZLIB
+				} else if (subType == MKTAG('Z','F','O','B') && subSize >= 4) {
+					byte *compressed = (byte *)malloc(subSize);
+					file.read(compressed, subSize);
+					unsigned long decompressedSize = READ_BE_UINT32(compressed);
+					chunk = (byte *)malloc(decompressedSize);
+					if (!Common::uncompress(chunk, &decompressedSize, compressed + 4, subSize - 4))
+						error("SmushPlayer::benchmark() Zlib uncompress error");
+					free(compressed);
+					if (decompressedSize < 14) {
+						free(chunk);
+						chunk = 0;
+					}
+#endif
+				}
+
+				if (chunk) {
+					const int codec = READ_LE_UINT16(chunk);
+					const int width = READ_LE_UINT16(chunk + 6);
+					const int height = READ_LE_UINT16(chunk + 8);
+
+					if (width * height > dstSize) {
+						dstSize = width * height;
+						dst = (byte *)realloc(dst, dstSize);
+					}
+
+					const uint32 decodeStart = _vm->_system->getMillis();
+					switch (codec) {
+					case 1:
+					case 3:
+						smush_decode_codec1(dst, chunk + 14, 0, 0, width, height, width);
+						break;
+					case 37:
+						if (!codec37)
+							codec37 = new Codec37Decoder(width, height);
+						codec37->decode(dst, chunk + 14);
+						break;
+					case 47:
+						if (!codec47)
+							codec47 = new Codec47Decoder(width, height);
+						codec47->decode(dst, chunk + 14);
+						break;
+					default:
+						break;
+					}
+					const uint32 decodeTime = _vm->_system->getMillis() - decodeStart;
+
+					uint i;
+					for (i = 0; i < stats.codecs.size() && stats.codecs[i].codec != codec; i++)
+						;
+					if (i == stats.codecs.size()) {
+						CodecStats codecStats;
+						codecStats.codec = codec;
+						codecStats.objects = 0;
+						codecStats.decodeTime = 0;
+						stats.codecs.push_back(codecStats);
+					}
+					stats.codecs[i].objects++;
+					stats.codecs[i].decodeTime += decodeTime;
+
+					free(chunk);
+				}
+
+				frameSize -= subSize + 8;
+				file.seek(subOffset + subSize, SEEK_SET);
+				if (subSize & 1) {
+					file.skip(1);
+					frameSize--;
+				}
+			}
+		}
+
+		file.seek(offset + size, SEEK_SET);
+	}
+
+	stats.totalTime = _vm->_system->getMillis() - startTime;
+
+	delete codec37;
+	delete codec47;
+	free(dst);
+
+	return true;
+}
+
+void SmushPlayer::handleChunk(uint32 type, int32 size, int32 offset, Common::SeekableReadStream &b) {
+	debug(3, "Chunk: %s at %x", tag2str(type), offset);
+
+	switch (type) {
 	case MKTAG('A','H','D','R'): // FT INSANE may seek file to the beginning
-		handleAnimHeader(subSize, *_base);
+		handleAnimHeader(size, b);
 		break;
 	case MKTAG('F','R','M','E'):
-		handleFrame(subSize, *_base);
+		handleFrame(size, b);
 		break;
 	default:
-		error("Unknown Chunk found at %x: %s, %d", subOffset, tag2str(subType), subSize);
+		error("Unknown Chunk found at %x: %s, %d", offset, tag2str(type), size);
 	}
+}
 
-	_base->seek(subOffset + subSize, SEEK_SET);
+void SmushPlayer::readAheadChunks() {
+	// FT INSANE seeks around in its files, and a pending seek invalidates
+	// any chunks read from the old position, so only read ahead otherwise
+	if (_insanity || _seekPos >= 0 || !_base)
+		return;
 
-	if (_insanity)
-		_vm->_sound->processSound();
+	while (_chunkQueue.size() < kChunkQueueSize) {
+		const int32 pos = _base->pos();
+		const uint32 subType = _base->readUint32BE();
+		const int32 subSize = _base->readUint32BE();
 
-	_vm->_imuseDigital->flushTracks();
+		// Leave the end of file handling to parseNextFrame()
+		if (_base->eos() || _base->pos() >= (int32)_baseSize || subSize < 0) {
+			_base->clearErr();
+			_base->seek(pos, SEEK_SET);
+			break;
+		}
+
+		QueuedChunk chunk;
+		chunk.type = subType;
+		chunk.offset = _base->pos();
+		chunk.size = subSize;
+		chunk.data = (byte *)malloc(subSize);
+		assert(chunk.data);
+		_base->read(chunk.data, subSize);
+		_chunkQueue.push(chunk);
+	}
+
+	if (_chunkQueue.size() > _chunkQueueMaxDepth)
+		_chunkQueueMaxDepth = _chunkQueue.size();
+}
+
+void SmushPlayer::clearChunkQueue() {
+	while (!_chunkQueue.empty())
+		free(_chunkQueue.pop().data);
 }
 
 void SmushPlayer::setPalette(const byte *palette) {
@@ -1176,6 +1373,11 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 
 	_pauseTime = 0;
 
+	_chunkQueueMaxDepth = 0;
+	_queueHits = 0;
+	_queueMisses = 0;
+	_lateFrames = 0;
+
 	int skipped = 0;
 
 	for (;;) {
@@ -1202,9 +1404,10 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 		}
 
 		if (elapsed >= ((_frame - _startFrame) * 1000) / _speed) {
-			if (elapsed >= ((_frame + 1) * 1000) / _speed)
+			if (elapsed >= ((_frame + 1) * 1000) / _speed) {
 				skipFrame = true;
-			else
+				_lateFrames++;
+			} else
 				skipFrame = false;
 			timerCallback();
 		}
@@ -1252,6 +1455,11 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 			_IACTpos = 0;
 			break;
 		}
+
+		// Use the time until the next frame is due to read ahead, so that
+		// slow file access does not delay the frame after it
+		readAheadChunks();
+
 		_vm->_system->delayMillis(10);
 	}
 
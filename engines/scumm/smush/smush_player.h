@@ -26,6 +26,8 @@
 #if !defined(SCUMM_SMUSH_PLAYER_H) && defined(ENABLE_SCUMM_7_8)
 #define SCUMM_SMUSH_PLAYER_H
 
+#include "common/array.h"
+#include "common/queue.h"
 #include "common/util.h"
 #include "scumm/sound.h"
 
@@ -40,6 +42,19 @@ class Codec47Decoder;
 
 class SmushPlayer {
 	friend class Insane;
+public:
+	struct CodecStats {
+		int codec;
+		uint32 objects;
+		uint32 decodeTime;	///< in ms, excluding I/O and zlib decompression
+	};
+
+	struct BenchmarkStats {
+		uint32 frames;
+		uint32 totalTime;	///< in ms, including I/O and zlib decompression
+		Common::Array<CodecStats> codecs;
+	};
+
 private:
 	ScummEngine_v7 *_vm;
 	int32 _nbframes;
@@ -85,6 +100,27 @@ private:
 	bool _middleAudio;
 	bool _skipPalette;
 
+	enum {
+		kChunkQueueSize = 8
+	};
+
+	/**
+	 * A top level chunk (frame or header) which has been read ahead of
+	 * time, while the player was waiting for the next frame to be due.
+	 */
+	struct QueuedChunk {
+		uint32 type;
+		int32 offset;	///< file offset of the chunk data, for debug output
+		int32 size;
+		byte *data;
+	};
+
+	Common::Queue<QueuedChunk> _chunkQueue;
+	int _chunkQueueMaxDepth;
+	uint32 _queueHits;
+	uint32 _queueMisses;
+	uint32 _lateFrames;
+
 public:
 	SmushPlayer(ScummEngine_v7 *scumm);
 	~SmushPlayer();
@@ -96,6 +132,14 @@ public:
 	void release();
 	void warpMouse(int x, int y, int buttons);
 
+	/**
+	 * Decode all frame objects of a SAN file as fast as possible, without
+	 * presenting them or playing any audio, and collect timing statistics
+	 * per codec.
+	 * @return false if the file could not be opened or is no SAN file
+	 */
+	bool benchmark(const char *filename, BenchmarkStats &stats);
+
 protected:
 	int _width, _height;
 
@@ -114,6 +158,9 @@ protected:
 private:
 	SmushFont *getFont(int font);
 	void parseNextFrame();
+	void handleChunk(uint32 type, int32 size, int32 offset, Common::SeekableReadStream &b);
+	void readAheadChunks();
+	void clearChunkQueue();
 	void init(int32 spped);
 	void setupAnim(const char *file);
 	void updateScreen();
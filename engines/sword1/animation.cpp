@@ -23,6 +23,7 @@
  *
  */
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/events.h"
 #include "common/keyboard.h"
@@ -73,6 +74,10 @@ MoviePlayer::MoviePlayer(SwordEngine *vm, Text *textMan, Audio::Mixer *snd, OSys
 	_decoderType = decoderType;
 	_decoder = decoder;
 
+	const int decodeAhead = ConfMan.getInt("video_decode_ahead");
+	if (decodeAhead > 0)
+		_decoder = new Video::DecodeAheadVideoDecoder(decoder, decodeAhead);
+
 	_white = 255;
 	_black = 0;
 }
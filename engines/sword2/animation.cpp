@@ -25,6 +25,7 @@
  * $Id$
  */
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/mutex.h"
 #include "common/system.h"
@@ -54,6 +55,10 @@ MoviePlayer::MoviePlayer(Sword2Engine *vm, Audio::Mixer *snd, OSystem *system, A
 	_decoderType = decoderType;
 	_decoder = decoder;
 
+	const int decodeAhead = ConfMan.getInt("video_decode_ahead");
+	if (decodeAhead > 0)
+		_decoder = new Video::DecodeAheadVideoDecoder(decoder, decodeAhead);
+
 	_white = 255;
 	_black = 0;
 }
@@ -25,13 +25,56 @@
 
 #include "sword25/console.h"
 #include "sword25/sword25.h"
+#include "sword25/kernel/kernel.h"
+#include "sword25/script/luascript.h"
+#include "sword25/script/luaprofiler.h"
 
 namespace Sword25 {
 
 Sword25Console::Sword25Console(Sword25Engine *vm) : GUI::Debugger(), _vm(vm) {
+	DCmd_Register("profile", WRAP_METHOD(Sword25Console, Cmd_Profile));
 }
 
 Sword25Console::~Sword25Console() {
 }
 
+bool Sword25Console::Cmd_Profile(int argc, const char **argv) {
+	if (argc < 2) {
+		DebugPrintf("Usage: %s start|stop|reset|dump [<count>]\n", argv[0]);
+		return true;
+	}
+
+	LuaScriptEngine *script = static_cast<LuaScriptEngine *>(Kernel::getInstance()->getScript());
+	LuaProfiler *profiler = script ? script->getProfiler() : 0;
+	if (!profiler) {
+		DebugPrintf("The script engine is not initialized\n");
+		return true;
+	}
+
+	Common::String command = argv[1];
+	if (command == "start") {
+		profiler->start();
+		DebugPrintf("Script profiling started\n");
+	} else if (command == "stop") {
+		profiler->stop();
+		DebugPrintf("Script profiling stopped\n");
+	} else if (command == "reset") {
+		profiler->reset();
+		DebugPrintf("Script profile cleared\n");
+	} else if (command == "dump") {
+		uint count = (argc > 2) ? atoi(argv[2]) : 20;
+		Common::Array<LuaProfiler::Entry> report = profiler->getReport();
+
+		DebugPrintf("%8s %8s %8s  %s\n", "calls", "total", "self", "function");
+		for (uint i = 0; i < report.size() && i < count; ++i)
+			DebugPrintf("%8d %8d %8d  %s\n", report[i].calls, report[i].totalTime, report[i].selfTime, report[i].name.c_str());
+		DebugPrintf("%d of %d functions shown, times in ms%s\n", MIN<uint>(count, report.size()), report.size(),
+		            profiler->isRunning() ? "" : " (profiler is stopped)");
+	} else {
+		DebugPrintf("Unknown profile command '%s'\n", argv[1]);
+	}
+
+	return true;
+}
+
 } // End of namespace Sword25
@@ -39,6 +39,8 @@ public:
 
 private:
 	Sword25Engine *_vm;
+
+	bool Cmd_Profile(int argc, const char **argv);
 };
 
 } // End of namespace Sword25
@@ -42,7 +42,7 @@
 #ifdef USE_THEORADEC
 #include "common/system.h"
 #include "common/textconsole.h"
-#include "graphics/conversion.h"
+#include "graphics/yuv_to_rgb.h"
 #include "audio/decoders/raw.h"
 #include "sword25/kernel/common.h"
 
@@ -57,6 +57,7 @@ static double rint(double v) {
 TheoraDecoder::TheoraDecoder(Audio::Mixer *mixer, Audio::Mixer::SoundType soundType) : _mixer(mixer) {
 	_fileStream = 0;
 	_surface = 0;
+	_yuvConverter = new Graphics::YUVToRGB(getPixelFormat());
 
 	_theoraPacket = 0;
 	_vorbisPacket = 0;
@@ -80,6 +81,7 @@ TheoraDecoder::~TheoraDecoder() {
 	close();
 	delete _fileStream;
 	delete _audHandle;
+	delete _yuvConverter;
 	free(_audiobuf);
 }
 
@@ -496,15 +498,6 @@ Audio::QueuingAudioStream *TheoraDecoder::createAudioStream() {
 	return Audio::makeQueuingAudioStream(_vorbisInfo.rate, _vorbisInfo.channels);
 }
 
-static void convertYUVtoBGRA(int y, int u, int v, byte *dst) {
-	byte r, g, b;
-	Graphics::YUV2RGB(y, u, v, r, g, b);
-	*(dst + 0) = b;
-	*(dst + 1) = g;
-	*(dst + 2) = r;
-	*(dst + 3) = 0xFF;
-}
-
 enum TheoraYUVBuffers {
 	kBufferY = 0,
 	kBufferU = 1,
@@ -524,40 +517,13 @@ void TheoraDecoder::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, byte *pixelDa
 	assert(YUVBuffer[kBufferU].height == YUVBuffer[kBufferY].height >> 1);
 	assert(YUVBuffer[kBufferV].height == YUVBuffer[kBufferY].height >> 1);
 
-	const byte *ySrc = YUVBuffer[kBufferY].data;
-	const byte *uSrc = YUVBuffer[kBufferU].data;
-	const byte *vSrc = YUVBuffer[kBufferV].data;
-	byte *dst  = pixelData;
-	int u = 0, v = 0;
-
-	const int blockSize = YUVBuffer[kBufferY].width << 2;
-	const int halfHeight = YUVBuffer[kBufferY].height >> 1;
-	const int halfWidth = YUVBuffer[kBufferY].width >> 1;
-	const int yStep = (YUVBuffer[kBufferY].stride << 1) - YUVBuffer[kBufferY].width;
-	// The UV step is usually 0, since in most cases stride == width.
-	// The asserts at the top ensure that the U and V steps are equal
-	// (and they must always be equal)
-	const int uvStep = YUVBuffer[kBufferU].stride - YUVBuffer[kBufferU].width;
-	const int stride = YUVBuffer[kBufferY].stride;
-
-	for (int h = 0; h < halfHeight; ++h) {
-		for (int w = 0; w < halfWidth; ++w) {
-			u = *uSrc++;
-			v = *vSrc++;
-
-			for (int i = 0; i <= 1; i++) {
-				convertYUVtoBGRA(*ySrc, u, v, dst);
-				convertYUVtoBGRA(*(ySrc + stride), u, v, dst + blockSize);
-				ySrc++;
-				dst += 4;	// BGRA
-			}
-		}
+	// The U and V steps are equal as well
+	assert(YUVBuffer[kBufferU].stride == YUVBuffer[kBufferV].stride);
 
-		dst   += blockSize;
-		ySrc  += yStep;
-		uSrc  += uvStep;
-		vSrc  += uvStep;
-	}
+	_yuvConverter->convert420(pixelData, _surface->pitch,
+			YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data,
+			YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height,
+			YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
 }
 
 } // End of namespace Sword25
@@ -44,6 +44,10 @@ namespace Common {
 class SeekableReadStream;
 }
 
+namespace Graphics {
+class YUVToRGB;
+}
+
 //#define ENABLE_THEORA_SEEKING		// enables the extra calculations used for video seeking
 
 namespace Sword25 {
@@ -115,6 +119,7 @@ private:
 private:
 	Common::SeekableReadStream *_fileStream;
 	Graphics::Surface *_surface;
+	Graphics::YUVToRGB *_yuvConverter;
 	Common::Rational _frameRate;
 	uint32 _frameCount;
 
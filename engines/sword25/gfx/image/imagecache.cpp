@@ -0,0 +1,155 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "common/config-manager.h"
+#include "common/hash-str.h"
+#include "common/savefile.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "sword25/sword25.h"	// for kDebugResource
+#include "sword25/gfx/image/imagecache.h"
+
+namespace Sword25 {
+
+static const uint32 IMAGECACHE_MARKER = MKTAG('S', '2', '5', 'I');
+static const uint32 IMAGECACHE_VERSION = 1;
+
+bool ImageCache::isEnabled() {
+	return ConfMan.hasKey("image_cache") && ConfMan.getBool("image_cache");
+}
+
+Common::String ImageCache::getCacheFileName(const Common::String &fileName) {
+	return Common::String::format("%s.img%08x", ConfMan.getActiveDomainName().c_str(), Common::hashit(fileName));
+}
+
+uint32 ImageCache::computeChecksum(Common::SeekableReadStream &stream) {
+	// FNV-1a; this only has to detect changed image files, and is
+	// negligible compared to the decoding work it saves
+	uint32 hash = 2166136261U;
+	byte buffer[4096];
+
+	stream.seek(0, SEEK_SET);
+	uint32 bytesRead;
+	while ((bytesRead = stream.read(buffer, sizeof(buffer))) > 0) {
+		for (uint32 i = 0; i < bytesRead; ++i) {
+			hash ^= buffer[i];
+			hash *= 16777619U;
+		}
+	}
+	stream.seek(0, SEEK_SET);
+
+	return hash;
+}
+
+bool ImageCache::load(const Common::String &fileName, uint32 fileSize, uint32 checksum,
+	                  byte *&uncompressedDataPtr, int &width, int &height, int &pitch) {
+	// The entries are named after the game domain, so they are kept in the
+	// save path of the application, not in the one of the game
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::InSaveFile *in = saveFileMan ? saveFileMan->openGlobalForLoading(getCacheFileName(fileName)) : 0;
+	if (!in)
+		return false;
+
+	bool valid = false;
+	if (in->readUint32BE() == IMAGECACHE_MARKER && in->readUint32LE() == IMAGECACHE_VERSION) {
+		// Check that the entry belongs to this file, and that the file hasn't changed
+		Common::String cachedName;
+		uint16 nameLength = in->readUint16LE();
+		for (uint16 i = 0; i < nameLength; ++i)
+			cachedName += (char)in->readByte();
+
+		uint32 cachedSize = in->readUint32LE();
+		uint32 cachedChecksum = in->readUint32LE();
+
+		valid = !in->err() && cachedName == fileName && cachedSize == fileSize &&
+		        cachedChecksum == checksum;
+	}
+
+	if (valid) {
+		width = in->readUint32LE();
+		height = in->readUint32LE();
+		pitch = in->readUint32LE();
+
+		// The pixel data makes up the rest of the entry. Anything else means
+		// the entry is damaged, and the image is decoded again instead.
+		const int32 remaining = in->size() - in->pos();
+		valid = !in->err() && width > 0 && height > 0 && pitch / 4 >= width &&
+		        height <= remaining / pitch && pitch * height == remaining;
+	}
+
+	if (valid) {
+		uint dataSize = pitch * height;
+		uncompressedDataPtr = new byte[dataSize];
+		if (in->read(uncompressedDataPtr, dataSize) != dataSize || in->err()) {
+			delete[] uncompressedDataPtr;
+			uncompressedDataPtr = 0;
+			valid = false;
+		}
+	}
+
+	delete in;
+
+	if (valid)
+		debugC(2, kDebugResource, "Loaded decoded image \"%s\" from cache.", fileName.c_str());
+	else
+		debugC(2, kDebugResource, "Stale image cache entry for \"%s\".", fileName.c_str());
+
+	return valid;
+}
+
+void ImageCache::store(const Common::String &fileName, uint32 fileSize, uint32 checksum,
+	                   const byte *uncompressedDataPtr, int width, int height, int pitch) {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::OutSaveFile *out = saveFileMan ? saveFileMan->openGlobalForSaving(getCacheFileName(fileName)) : 0;
+	if (!out)
+		return;
+
+	out->writeUint32BE(IMAGECACHE_MARKER);
+	out->writeUint32LE(IMAGECACHE_VERSION);
+	out->writeUint16LE(fileName.size());
+	out->write(fileName.c_str(), fileName.size());
+	out->writeUint32LE(fileSize);
+	out->writeUint32LE(checksum);
+	out->writeUint32LE(width);
+	out->writeUint32LE(height);
+	out->writeUint32LE(pitch);
+	out->write(uncompressedDataPtr, pitch * height);
+	out->finalize();
+
+	bool failed = out->err();
+	delete out;
+
+	// A truncated entry fails the size check in load(), and is replaced the
+	// next time the image is stored
+	if (failed) {
+		warning("Could not write image cache entry for \"%s\"", fileName.c_str());
+	} else {
+		debugC(2, kDebugResource, "Stored decoded image \"%s\" in cache.", fileName.c_str());
+	}
+}
+
+} // End of namespace Sword25
@@ -0,0 +1,91 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef SWORD25_IMAGECACHE_H
+#define SWORD25_IMAGECACHE_H
+
+#include "sword25/kernel/common.h"
+
+namespace Common {
+class SeekableReadStream;
+}
+
+namespace Sword25 {
+
+/**
+ * On-disk cache for decoded images.
+ *
+ * Decoding the large PNG backgrounds and animation frames is a noticeable
+ * part of the time needed to enter a scene. When enabled through the
+ * "image_cache" config option, every image decoded from the game packages
+ * is additionally stored as raw ARGB data in the savefile area, where the
+ * savefile manager compresses it. On subsequent visits the decoded data
+ * is read back instead of decoding the PNG again.
+ *
+ * Cache entries are keyed by the absolute path of the image in the package
+ * file system, and validated against the size and a checksum of the PNG
+ * data, so updated patch packages automatically invalidate stale entries.
+ */
+class ImageCache {
+public:
+	/**
+	 * Returns true if the decoded image cache has been enabled by the user.
+	 */
+	static bool isEnabled();
+
+	/**
+	 * Compute the checksum used to validate cache entries. The stream is
+	 * rewound to its start afterwards.
+	 */
+	static uint32 computeChecksum(Common::SeekableReadStream &stream);
+
+	/**
+	 * Try to load a decoded image from the cache.
+	 * @param[in] fileName		absolute path of the image in the package file system
+	 * @param[in] fileSize		size of the (still encoded) image data in bytes
+	 * @param[in] checksum		checksum of the encoded image data, see computeChecksum()
+	 * @param[out] uncompressedDataPtr	if successful, this is set to a newly allocated buffer with the image data
+	 * @param[out] width		if successful, this is set to the width of the image
+	 * @param[out] height		if successful, this is set to the height of the image
+	 * @param[out] pitch		if successful, this is set to the number of bytes per scanline in the image
+	 * @return true if a valid cache entry was found
+	 */
+	static bool load(const Common::String &fileName, uint32 fileSize, uint32 checksum,
+	                 byte *&uncompressedDataPtr, int &width, int &height, int &pitch);
+
+	/**
+	 * Store a decoded image in the cache. Failures are silently ignored,
+	 * since the cache is only an optimization.
+	 */
+	static void store(const Common::String &fileName, uint32 fileSize, uint32 checksum,
+	                  const byte *uncompressedDataPtr, int width, int height, int pitch);
+
+private:
+	static Common::String getCacheFileName(const Common::String &fileName);
+};
+
+} // End of namespace Sword25
+
+#endif
@@ -42,6 +42,7 @@
 
 #include "common/memstream.h"
 #include "sword25/gfx/image/image.h"
+#include "sword25/gfx/image/imagecache.h"
 #include "sword25/gfx/image/pngloader.h"
 #ifndef USE_INTERNAL_PNG_DECODER
 #include <png.h>
@@ -70,21 +71,23 @@ static Common::String loadString(Common::ReadStream &in, uint maxSize = 999) {
 }
 
 /**
- * Check if the given data is a savegame, and if so, locate the
+ * Check if the given stream contains a savegame, and if so, locate the
  * offset to the image data.
- * @return offset to image data if fileDataPtr contains a savegame; 0 otherwise
+ * @return offset to image data if the stream contains a savegame; 0 otherwise
  */
-static uint findEmbeddedPNG(const byte *fileDataPtr, uint fileSize) {
-	if (fileSize < 100)
-		return 0;
-	if (memcmp(fileDataPtr, "BS25SAVEGAME", 12))
+static uint findEmbeddedPNG(Common::SeekableReadStream &stream) {
+	if (stream.size() < 100)
 		return 0;
 
-	// Read in the header
-	Common::MemoryReadStream stream(fileDataPtr, fileSize);
+	char marker[12];
 	stream.seek(0, SEEK_SET);
+	if (stream.read(marker, sizeof(marker)) != sizeof(marker) || memcmp(marker, "BS25SAVEGAME", 12)) {
+		stream.seek(0, SEEK_SET);
+		return 0;
+	}
 
 	// Read header information of savegame
+	stream.seek(0, SEEK_SET);
 	uint compressedGamedataSize;
 	loadString(stream);		// Marker
 	loadString(stream);		// Version
@@ -97,6 +100,16 @@ static uint findEmbeddedPNG(const byte *fileDataPtr, uint fileSize) {
 	return static_cast<uint>(stream.pos() + compressedGamedataSize);
 }
 
+/**
+ * Check if the given data is a savegame, and if so, locate the
+ * offset to the image data.
+ * @return offset to image data if fileDataPtr contains a savegame; 0 otherwise
+ */
+static uint findEmbeddedPNG(const byte *fileDataPtr, uint fileSize) {
+	Common::MemoryReadStream stream(fileDataPtr, fileSize);
+	return findEmbeddedPNG(stream);
+}
+
 #ifndef USE_INTERNAL_PNG_DECODER
 static void png_user_read_data(png_structp png_ptr, png_bytep data, png_size_t length) {
 	const byte **ref = (const byte **)png_get_io_ptr(png_ptr);
@@ -214,10 +227,28 @@ bool PNGLoader::doDecodeImage(const byte *fileDataPtr, uint fileSize, byte *&unc
 
 	// Destroy libpng structures
 	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+
+	// Signal success
+	return true;
+#else
+	return doDecodeImage(new Common::MemoryReadStream(fileDataPtr, fileSize, DisposeAfterUse::NO), uncompressedDataPtr, width, height, pitch);
+#endif
+}
+
+bool PNGLoader::doDecodeImage(Common::SeekableReadStream *stream, byte *&uncompressedDataPtr, int &width, int &height, int &pitch) {
+#ifndef USE_INTERNAL_PNG_DECODER
+	// libpng needs the whole image in memory
+	uint fileSize = stream->size() - stream->pos();
+	byte *fileDataPtr = new byte[fileSize];
+	stream->read(fileDataPtr, fileSize);
+	delete stream;
+
+	bool result = doDecodeImage(fileDataPtr, fileSize, uncompressedDataPtr, width, height, pitch);
+	delete[] fileDataPtr;
+	return result;
 #else
-	Common::MemoryReadStream *fileStr = new Common::MemoryReadStream(fileDataPtr, fileSize, DisposeAfterUse::NO);
 	Graphics::PNG *png = new Graphics::PNG();
-	if (!png->read(fileStr))	// the fileStr pointer, and thus pFileData will be deleted after this is done
+	if (!png->read(stream))	// the stream will be deleted after this is done
 		error("Error while reading PNG image");
 
 	Graphics::PixelFormat format = Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
@@ -225,6 +256,7 @@ bool PNGLoader::doDecodeImage(const byte *fileDataPtr, uint fileSize, byte *&unc
 
 	width = pngSurface->w;
 	height = pngSurface->h;
+	pitch = pngSurface->pitch;
 	uncompressedDataPtr = new byte[pngSurface->pitch * pngSurface->h];
 	memcpy(uncompressedDataPtr, (byte *)pngSurface->pixels, pngSurface->pitch * pngSurface->h);
 	pngSurface->free();
@@ -232,9 +264,9 @@ bool PNGLoader::doDecodeImage(const byte *fileDataPtr, uint fileSize, byte *&unc
 	delete pngSurface;
 	delete png;
 
-#endif
 	// Signal success
 	return true;
+#endif
 }
 
 bool PNGLoader::decodeImage(const byte *fileDataPtr, uint fileSize, byte *&uncompressedDataPtr, int &width, int &height, int &pitch) {
@@ -242,6 +274,30 @@ bool PNGLoader::decodeImage(const byte *fileDataPtr, uint fileSize, byte *&uncom
 	return doDecodeImage(fileDataPtr + pngOffset, fileSize - pngOffset, uncompressedDataPtr, width, height, pitch);
 }
 
+bool PNGLoader::decodeImage(const Common::String &fileName, Common::SeekableReadStream *stream, byte *&uncompressedDataPtr, int &width, int &height, int &pitch) {
+	// Savegame thumbnails change all the time, so there is no point in caching them
+	bool useCache = ImageCache::isEnabled() && !fileName.hasSuffix(".b25s");
+
+	uint32 checksum = 0;
+	uint32 fileSize = stream->size();
+	if (useCache) {
+		checksum = ImageCache::computeChecksum(*stream);
+		if (ImageCache::load(fileName, fileSize, checksum, uncompressedDataPtr, width, height, pitch)) {
+			delete stream;
+			return true;
+		}
+	}
+
+	stream->seek(findEmbeddedPNG(*stream), SEEK_SET);
+	if (!doDecodeImage(stream, uncompressedDataPtr, width, height, pitch))
+		return false;
+
+	if (useCache)
+		ImageCache::store(fileName, fileSize, checksum, uncompressedDataPtr, width, height, pitch);
+
+	return true;
+}
+
 bool PNGLoader::doImageProperties(const byte *fileDataPtr, uint fileSize, int &width, int &height) {
 #ifndef USE_INTERNAL_PNG_DECODER
 	// Check for valid PNG signature
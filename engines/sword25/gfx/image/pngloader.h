@@ -38,6 +38,10 @@
 #include "sword25/kernel/common.h"
 #include "sword25/gfx/graphicengine.h"
 
+namespace Common {
+class SeekableReadStream;
+}
+
 namespace Sword25 {
 
 /**
@@ -50,6 +54,7 @@ protected:
 	PNGLoader() {}	// Protected constructor to prevent instances
 
 	static bool doDecodeImage(const byte *fileDataPtr, uint fileSize, byte *&uncompressedDataPtr, int &width, int &height, int &pitch);
+	static bool doDecodeImage(Common::SeekableReadStream *stream, byte *&uncompressedDataPtr, int &width, int &height, int &pitch);
 	static bool doImageProperties(const byte *fileDataPtr, uint fileSize, int &width, int &height);
 
 public:
@@ -72,6 +77,26 @@ public:
 	                        byte *&pUncompressedData,
 	                        int &width, int &height,
 	                        int &pitch);
+
+	/**
+	 * Decode an image from a stream, e.g. one returned by PackageManager::getStream().
+	 * Decoding directly from the stream avoids copying the file data first.
+	 * The decoded image cache (see ImageCache) is consulted first, and newly
+	 * decoded images are stored in it.
+	 * @param[in] fileName		absolute path of the image, used as cache key
+	 * @param[in] stream		the stream to decode; ownership is transferred to the loader
+	 * @param[out] pUncompressedData	if successful, this is set to a pointer containing the decoded image data
+	 * @param[out] width		if successful, this is set to the width of the image
+	 * @param[out] height		if successful, this is set to the height of the image
+	 * @param[out] pitch		if successful, this is set to the number of bytes per scanline in the image
+	 * @return false in case of an error
+	 */
+	static bool decodeImage(const Common::String &fileName,
+	                        Common::SeekableReadStream *stream,
+	                        byte *&pUncompressedData,
+	                        int &width, int &height,
+	                        int &pitch);
+
 	/**
 	 * Extract the properties of an image.
 	 * @param[in] fileDatePtr	pointer to the image data
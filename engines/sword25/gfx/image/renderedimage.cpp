@@ -59,33 +59,20 @@ RenderedImage::RenderedImage(const Common::String &filename, bool &result) :
 
 	_backSurface = Kernel::getInstance()->getGfx()->getSurface();
 
-	// Load file
-	byte *pFileData;
-	uint fileSize;
-	pFileData = pPackage->getFile(filename, &fileSize);
-	if (!pFileData) {
+	// Open the file. The stream hands out the package data without copying it.
+	Common::SeekableReadStream *in = pPackage->getStream(filename);
+	if (!in) {
 		error("File \"%s\" could not be loaded.", filename.c_str());
 		return;
 	}
 
-	// Determine image properties
-	int pitch;
-	if (!PNGLoader::imageProperties(pFileData, fileSize, _width, _height)) {
-		error("Could not read image properties.");
-		delete[] pFileData;
-		return;
-	}
-
 	// Uncompress the image
-	if (!PNGLoader::decodeImage(pFileData, fileSize, _data, _width, _height, pitch)) {
+	int pitch;
+	if (!PNGLoader::decodeImage(pPackage->getAbsolutePath(filename), in, _data, _width, _height, pitch)) {
 		error("Could not decode image.");
-		delete[] pFileData;
 		return;
 	}
 
-	// Cleanup FileData
-	delete[] pFileData;
-
 	_doCleanup = true;
 
 	result = true;
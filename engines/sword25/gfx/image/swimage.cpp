@@ -47,32 +47,21 @@ SWImage::SWImage(const Common::String &filename, bool &result) :
 	PackageManager *pPackage = Kernel::getInstance()->getPackage();
 	assert(pPackage);
 
-	// Load file
-	byte *pFileData;
-	uint fileSize;
-	pFileData = pPackage->getFile(filename, &fileSize);
-	if (!pFileData) {
+	// Open the file. The stream hands out the package data without copying it.
+	Common::SeekableReadStream *in = pPackage->getStream(filename);
+	if (!in) {
 		error("File \"%s\" could not be loaded.", filename.c_str());
 		return;
 	}
 
-	// Determine image properties
-	int pitch;
-	if (!PNGLoader::imageProperties(pFileData, fileSize, _width, _height)) {
-		error("Could not read image properties.");
-		return;
-	}
-
 	// Uncompress the image
+	int pitch;
 	byte *pUncompressedData;
-	if (!PNGLoader::decodeImage(pFileData, fileSize, pUncompressedData, _width, _height, pitch)) {
+	if (!PNGLoader::decodeImage(pPackage->getAbsolutePath(filename), in, pUncompressedData, _width, _height, pitch)) {
 		error("Could not decode image.");
 		return;
 	}
 
-	// Cleanup FileData
-	delete[] pFileData;
-
 	_imageDataPtr = (uint *)pUncompressedData;
 
 	result = true;
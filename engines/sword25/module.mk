@@ -24,6 +24,7 @@ MODULE_OBJS := \
 	gfx/text.o \
 	gfx/timedrenderobject.o \
 	gfx/image/art.o \
+	gfx/image/imagecache.o \
 	gfx/image/pngloader.o \
 	gfx/image/renderedimage.o \
 	gfx/image/swimage.o \
@@ -49,6 +50,7 @@ MODULE_OBJS := \
 	package/packagemanager_script.o \
 	script/luabindhelper.o \
 	script/luacallback.o \
+	script/luaprofiler.o \
 	script/luascript.o \
 	script/lua_extensions.o \
 	sfx/soundengine.o \
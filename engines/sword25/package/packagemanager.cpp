@@ -142,33 +142,8 @@ bool PackageManager::loadDirectoryAsPackage(const Common::String &directoryName,
 }
 
 byte *PackageManager::getFile(const Common::String &fileName, uint *fileSizePtr) {
-	const Common::String B25S_EXTENSION(".b25s");
-	Common::SeekableReadStream *in;
-
-	if (fileName.hasSuffix(B25S_EXTENSION)) {
-		// Savegame loading logic
-		Common::SaveFileManager *sfm = g_system->getSavefileManager();
-		Common::InSaveFile *file = sfm->openForLoading(
-			FileSystemUtil::getPathFilename(fileName));
-		if (!file) {
-			error("Could not load savegame \"%s\".", fileName.c_str());
-			return 0;
-		}
-
-		if (fileSizePtr)
-			*fileSizePtr = file->size();
-
-		byte *buffer = new byte[file->size()];
-		file->read(buffer, file->size());
-		
-		delete file;
-		return buffer;
-	}
-
-	Common::ArchiveMemberPtr fileNode = getArchiveMember(normalizePath(fileName, _currentDirectory));
-	if (!fileNode)
-		return 0;
-	if (!(in = fileNode->createReadStream()))
+	Common::SeekableReadStream *in = getStream(fileName);
+	if (!in)
 		return 0;
 
 	// If the filesize is desired, then output the size
@@ -188,15 +163,53 @@ byte *PackageManager::getFile(const Common::String &fileName, uint *fileSizePtr)
 	return buffer;
 }
 
+char *PackageManager::getXmlFile(const Common::String &fileName, uint *fileSizePtr) {
+	const char *versionStr = "<?xml version=\"1.0\"?>";
+	const uint versionLength = strlen(versionStr);
+
+	Common::SeekableReadStream *in = getStream(fileName);
+	if (!in)
+		return 0;
+
+	// Read the file straight behind the version key, instead of going through
+	// an intermediate copy made by getFile()
+	uint fileSize = in->size();
+	char *result = (char *)malloc(versionLength + fileSize + 1);
+	memcpy(result, versionStr, versionLength);
+	uint bytesRead = in->read(result + versionLength, fileSize);
+	delete in;
+
+	if (bytesRead != fileSize) {
+		free(result);
+		return 0;
+	}
+
+	result[versionLength + fileSize] = '\0';
+	if (fileSizePtr)
+		*fileSizePtr = versionLength + fileSize;
+
+	return result;
+}
+
 Common::SeekableReadStream *PackageManager::getStream(const Common::String &fileName) {
-	Common::SeekableReadStream *in;
+	const Common::String B25S_EXTENSION(".b25s");
+
+	if (fileName.hasSuffix(B25S_EXTENSION)) {
+		// Savegame loading logic
+		Common::SaveFileManager *sfm = g_system->getSavefileManager();
+		Common::InSaveFile *file = sfm->openForLoading(
+			FileSystemUtil::getPathFilename(fileName));
+		if (!file)
+			error("Could not load savegame \"%s\".", fileName.c_str());
+
+		return file;
+	}
+
 	Common::ArchiveMemberPtr fileNode = getArchiveMember(normalizePath(fileName, _currentDirectory));
 	if (!fileNode)
 		return 0;
-	if (!(in = fileNode->createReadStream()))
-		return 0;
 
-	return in;
+	return fileNode->createReadStream();
 }
 
 bool PackageManager::changeDirectory(const Common::String &directory) {
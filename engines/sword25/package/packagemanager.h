@@ -122,13 +122,17 @@ public:
 	 * @param pFileSize     Pointer to the variable that will contain the size of the loaded file. The deafult is NULL.
 	 * @return              Specifies a pointer to the loaded data of the file
 	 * @remark              The client must not forget to release the data of the file using BE_DELETE_A.
+	 * @remark              This copies the whole file. Clients which can work on a stream should use
+	 *                      getStream() instead, which hands out the archive data without a copy.
 	 */
 	byte *getFile(const Common::String &fileName, uint *pFileSize = NULL);
 
 	/**
 	 * Returns a stream from file file from the directory tree
 	 * @param FileName      The filename of the file to load
-	 * @return              Pointer to the stream object
+	 * @return              Pointer to the stream object, or NULL if the file was not found
+	 * @remark              Savegames (*.b25s) are opened through the savefile manager.
+	 * @remark              The stream is owned by the client, who must delete it after use.
 	 */
 	Common::SeekableReadStream *getStream(const Common::String &fileName);
 	/**
@@ -136,25 +140,11 @@ public:
 	 * and it is required for ScummVM to correctly parse the XML.
 	 * @param FileName      The filename of the file to load
 	 * @param pFileSize     Pointer to the variable that will contain the size of the loaded file. The deafult is NULL.
-	 * @return              Specifies a pointer to the loaded data of the file
-	 * @remark              The client must not forget to release the data of the file using BE_DELETE_A.
+	 * @return              Specifies a pointer to the loaded data of the file, or NULL if it could not be loaded
+	 * @remark              The client must not forget to release the data of the file using free().
 	 */
-	char *getXmlFile(const Common::String &fileName, uint *pFileSize = NULL) {
-		const char *versionStr = "<?xml version=\"1.0\"?>";
-		uint fileSize;
-		char *data = (char *)getFile(fileName, &fileSize);
-		char *result = (char *)malloc(fileSize + strlen(versionStr) + 1);
-		strcpy(result, versionStr);
-		Common::copy(data, data + fileSize, result + strlen(versionStr));
-		result[fileSize + strlen(versionStr)] = '\0';
-
-		delete[] data;
-		if (pFileSize)
-			*pFileSize = fileSize + strlen(versionStr);
-
-		return result;
-	}
-	
+	char *getXmlFile(const Common::String &fileName, uint *pFileSize = NULL);
+
 	/**
 	 * Returns the path to the current directory.
 	 * @return              Returns a string containing the path to the current directory.
@@ -0,0 +1,212 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "common/algorithm.h"
+#include "common/system.h"
+
+#include "sword25/script/luaprofiler.h"
+
+namespace Sword25 {
+
+namespace {
+const char *METATABLES_TABLE_NAME = "__METATABLES";
+
+struct EntrySelfTimeGreater {
+	bool operator()(const LuaProfiler::Entry &a, const LuaProfiler::Entry &b) const {
+		if (a.selfTime != b.selfTime)
+			return a.selfTime > b.selfTime;
+		return a.calls > b.calls;
+	}
+};
+}
+
+LuaProfiler *LuaProfiler::_instance = 0;
+
+LuaProfiler::LuaProfiler(lua_State *L) :
+	_state(L),
+	_running(false),
+	_oldHook(0),
+	_oldHookMask(0),
+	_oldHookCount(0) {
+}
+
+LuaProfiler::~LuaProfiler() {
+	stop();
+}
+
+void LuaProfiler::start() {
+	if (_running)
+		return;
+
+	// Only one profiler can own the hook at a time
+	assert(!_instance);
+	_instance = this;
+
+	// Build the names of all registered C bindings. Since libraries and
+	// classes can be registered at any time, this is redone on every start.
+	// Library functions are named Library.function, class methods Class:method.
+	_cFunctionNames.clear();
+	lua_pushvalue(_state, LUA_GLOBALSINDEX);
+	collectCFunctionNames("", '.', 1);
+	lua_pop(_state, 1);
+	lua_getglobal(_state, METATABLES_TABLE_NAME);
+	if (lua_istable(_state, -1))
+		collectCFunctionNames("", ':', 1);
+	lua_pop(_state, 1);
+
+	// Remember the current (debug) hook, so that it can be restored later on
+	_oldHook = lua_gethook(_state);
+	_oldHookMask = lua_gethookmask(_state);
+	_oldHookCount = lua_gethookcount(_state);
+
+	_callStacks.clear();
+	lua_sethook(_state, hook, LUA_MASKCALL | LUA_MASKRET, 0);
+	_running = true;
+}
+
+void LuaProfiler::stop() {
+	if (!_running)
+		return;
+
+	lua_sethook(_state, _oldHook, _oldHookMask, _oldHookCount);
+	_callStacks.clear();
+	_instance = 0;
+	_running = false;
+}
+
+void LuaProfiler::reset() {
+	// Frames on the call stacks point into the entry map, so both have to go
+	_callStacks.clear();
+	_entries.clear();
+}
+
+Common::Array<LuaProfiler::Entry> LuaProfiler::getReport() const {
+	Common::Array<Entry> report;
+	for (EntryMap::const_iterator it = _entries.begin(); it != _entries.end(); ++it)
+		report.push_back(it->_value);
+
+	Common::sort(report.begin(), report.end(), EntrySelfTimeGreater());
+	return report;
+}
+
+void LuaProfiler::collectCFunctionNames(const Common::String &prefix, char separator, int depth) {
+	// The table to scan is at the top of the stack
+	lua_pushnil(_state);
+	while (lua_next(_state, -2) != 0) {
+		// Only look at string keys; lua_tostring() would convert other keys in place and confuse lua_next()
+		if (lua_type(_state, -2) == LUA_TSTRING) {
+			Common::String key = lua_tostring(_state, -2);
+
+			if (lua_iscfunction(_state, -1)) {
+				lua_CFunction function = lua_tocfunction(_state, -1);
+				if (!_cFunctionNames.contains(function))
+					_cFunctionNames[function] = prefix + key;
+			} else if (lua_istable(_state, -1) && depth > 0 &&
+			           key != "_G" && key != "package" && key != METATABLES_TABLE_NAME) {
+				collectCFunctionNames(prefix + key + separator, separator, depth - 1);
+			}
+		}
+
+		lua_pop(_state, 1);
+	}
+}
+
+void LuaProfiler::hook(lua_State *L, lua_Debug *ar) {
+	if (_instance)
+		_instance->handleEvent(L, ar);
+}
+
+void LuaProfiler::handleEvent(lua_State *L, lua_Debug *ar) {
+	uint32 now = g_system->getMillis();
+	Common::Array<Frame> &callStack = _callStacks[L];
+
+	if (ar->event == LUA_HOOKCALL) {
+		Frame frame;
+		frame.entry = lookupEntry(L, ar);
+		frame.startTime = now;
+		frame.childTime = 0;
+		frame.entry->calls++;
+		callStack.push_back(frame);
+	} else if (ar->event == LUA_HOOKRET || ar->event == LUA_HOOKTAILRET) {
+		// Calls made before profiling was started have no frame
+		if (callStack.empty())
+			return;
+
+		Frame frame = callStack.back();
+		callStack.pop_back();
+
+		// Millisecond timestamps are coarse, but the truncation errors
+		// cancel out when summed over many calls
+		uint32 elapsed = now - frame.startTime;
+		frame.entry->totalTime += elapsed;
+		frame.entry->selfTime += elapsed - MIN(elapsed, frame.childTime);
+
+		if (!callStack.empty())
+			callStack.back().childTime += elapsed;
+	}
+}
+
+LuaProfiler::Entry *LuaProfiler::lookupEntry(lua_State *L, lua_Debug *ar) {
+	Common::String key;
+	Common::String name;
+	bool isCFunction = false;
+
+	// 'f' pushes the called function, which is needed to identify C bindings
+	lua_getinfo(L, "Snf", ar);
+
+	if (lua_iscfunction(L, -1)) {
+		isCFunction = true;
+		CFunctionNameMap::const_iterator it = _cFunctionNames.find(lua_tocfunction(L, -1));
+		if (it != _cFunctionNames.end())
+			name = it->_value;
+		else
+			name = ar->name ? ar->name : "?";
+		key = "[C] " + name;
+		name = key;
+	} else {
+		key = Common::String::format("%s:%d", ar->short_src, ar->linedefined);
+		if (!strcmp(ar->what, "main"))
+			name = Common::String::format("main chunk (%s)", ar->short_src);
+		else
+			name = Common::String::format("%s (%s)", ar->name ? ar->name : "?", key.c_str());
+	}
+
+	lua_pop(L, 1);
+
+	EntryMap::iterator it = _entries.find(key);
+	if (it == _entries.end()) {
+		Entry &entry = _entries[key];
+		entry.name = name;
+		entry.isCFunction = isCFunction;
+		entry.calls = 0;
+		entry.totalTime = 0;
+		entry.selfTime = 0;
+		return &entry;
+	}
+
+	return &it->_value;
+}
+
+} // End of namespace Sword25
@@ -0,0 +1,111 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef SWORD25_LUAPROFILER_H
+#define SWORD25_LUAPROFILER_H
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+#include "sword25/kernel/common.h"
+#include "sword25/util/lua/lua.h"
+
+namespace Sword25 {
+
+/**
+ * Instrumenting profiler for the Lua scripts.
+ *
+ * While running, a call/return hook is installed via lua_sethook, which
+ * counts the calls of every Lua function and every C binding (e.g. the
+ * functions registered by graphicengine_script.cpp) and accumulates the
+ * time spent in them, both inclusive and exclusive of nested calls.
+ *
+ * Coroutines only get profiled if they are created after profiling has
+ * been started, since Lua copies the hook into new threads at creation.
+ */
+class LuaProfiler {
+public:
+	struct Entry {
+		Common::String name;
+		bool isCFunction;
+		uint32 calls;
+		uint32 totalTime;	///< time in ms, including nested calls
+		uint32 selfTime;	///< time in ms, excluding nested calls
+	};
+
+	LuaProfiler(lua_State *L);
+	~LuaProfiler();
+
+	void start();
+	void stop();
+	void reset();
+
+	bool isRunning() const { return _running; }
+
+	/**
+	 * Returns the collected statistics, sorted by descending self time.
+	 */
+	Common::Array<Entry> getReport() const;
+
+private:
+	struct Frame {
+		Entry *entry;
+		uint32 startTime;
+		uint32 childTime;
+	};
+
+	struct PointerHash {
+		template<typename T>
+		uint operator()(T ptr) const { return (uint)(size_t)ptr; }
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+	typedef Common::HashMap<lua_CFunction, Common::String, PointerHash> CFunctionNameMap;
+	typedef Common::HashMap<lua_State *, Common::Array<Frame>, PointerHash> CallStackMap;
+
+	lua_State *_state;
+	bool _running;
+
+	lua_Hook _oldHook;
+	int _oldHookMask;
+	int _oldHookCount;
+
+	EntryMap _entries;
+	CFunctionNameMap _cFunctionNames;
+	CallStackMap _callStacks;
+
+	static LuaProfiler *_instance;
+
+	static void hook(lua_State *L, lua_Debug *ar);
+	void handleEvent(lua_State *L, lua_Debug *ar);
+	Entry *lookupEntry(lua_State *L, lua_Debug *ar);
+	void collectCFunctionNames(const Common::String &prefix, char separator, int depth);
+};
+
+} // End of namespace Sword25
+
+#endif
@@ -39,6 +39,7 @@
 #include "sword25/package/packagemanager.h"
 #include "sword25/script/luascript.h"
 #include "sword25/script/luabindhelper.h"
+#include "sword25/script/luaprofiler.h"
 
 #include "sword25/kernel/outputpersistenceblock.h"
 #include "sword25/kernel/inputpersistenceblock.h"
@@ -53,10 +54,14 @@ namespace Sword25 {
 LuaScriptEngine::LuaScriptEngine(Kernel *KernelPtr) :
 	ScriptEngine(KernelPtr),
 	_state(0),
-	_pcallErrorhandlerRegistryIndex(0) {
+	_pcallErrorhandlerRegistryIndex(0),
+	_profiler(0) {
 }
 
 LuaScriptEngine::~LuaScriptEngine() {
+	// The profiler needs to remove its hook before the state goes away
+	delete _profiler;
+
 	// Lua de-initialisation
 	if (_state)
 		lua_close(_state);
@@ -133,6 +138,8 @@ bool LuaScriptEngine::init() {
 			lua_sethook(_state, debugHook, mask, 0);
 	}
 
+	_profiler = new LuaProfiler(_state);
+
 	debugC(kDebugScript, "Lua initialized.");
 
 	return true;
@@ -44,6 +44,7 @@
 namespace Sword25 {
 
 class Kernel;
+class LuaProfiler;
 
 class LuaScriptEngine : public ScriptEngine {
 public:
@@ -95,9 +96,17 @@ public:
 	 */
 	virtual bool unpersist(InputPersistenceBlock &reader);
 
+	/**
+	 * Returns the profiler for the scripts run by this engine.
+	 */
+	LuaProfiler *getProfiler() {
+		return _profiler;
+	}
+
 private:
 	lua_State *_state;
 	int _pcallErrorhandlerRegistryIndex;
+	LuaProfiler *_profiler;
 
 	bool registerStandardLibs();
 	bool registerStandardLibExtensions();
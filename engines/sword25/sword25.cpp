@@ -70,6 +70,7 @@ Sword25Engine::Sword25Engine(OSystem *syst, const ADGameDescription *gameDesc):
 	DebugMan.addDebugChannel(kDebugScript, "Script", "Script debug level");
 	DebugMan.addDebugChannel(kDebugScript, "Scripts", "Script debug level");
 	DebugMan.addDebugChannel(kDebugSound, "Sound", "Sound debug level");
+	DebugMan.addDebugChannel(kDebugResource, "Resource", "Resource debug level");
 
 	_console = new Sword25Console(this);
 }
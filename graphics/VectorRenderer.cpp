@@ -36,7 +36,12 @@ namespace Graphics {
  * DRAWSTEP handling functions
  ********************************************************************/
 void VectorRenderer::drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra) {
+	setupStep(step, extra);
 
+	(this->*(step.drawingCall))(area, step);
+}
+
+void VectorRenderer::setupStep(const DrawStep &step, uint32 extra) {
 	if (step.bgColor.set)
 		setBgColor(step.bgColor.r, step.bgColor.g, step.bgColor.b);
 
@@ -57,8 +62,6 @@ void VectorRenderer::drawStep(const Common::Rect &area, const DrawStep &step, ui
 	setFillMode((FillMode)step.fillMode);
 
 	_dynamicData = extra;
-
-	(this->*(step.drawingCall))(area, step);
 }
 
 int VectorRenderer::stepGetRadius(const DrawStep &step, const Common::Rect &area) {
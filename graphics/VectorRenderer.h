@@ -267,6 +267,13 @@ public:
 		_activeSurface = surface;
 	}
 
+	/**
+	 * Returns the active drawing surface.
+	 */
+	Surface *getSurface() const {
+		return _activeSurface;
+	}
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -419,6 +426,14 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets up the colors and drawing options of the specified draw step
+	 * the way drawStep() does, without drawing anything.
+	 *
+	 * @param step Pointer to a DrawStep struct.
+	 */
+	void setupStep(const DrawStep &step, uint32 extra = 0);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -475,6 +490,7 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool shadowsEnabled() const { return !_disableShadows; }
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
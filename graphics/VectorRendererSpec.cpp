@@ -36,6 +36,11 @@
 
 #define VECTOR_RENDERER_FAST_TRIANGLES
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define VECTOR_RENDERER_SSE2
+#endif
+
 /** Fixed point SQUARE ROOT **/
 inline frac_t fp_sqroot(uint32 x) {
 #if 0
@@ -186,7 +191,7 @@ namespace Graphics {
  * @param color Color of the pixel
  */
 template<typename PixelType>
-void colorFill(PixelType *first, PixelType *last, PixelType color) {
+inline void colorFillScalar(PixelType *first, PixelType *last, PixelType color) {
 	register int count = (last - first);
 	if (!count)
 		return;
@@ -205,6 +210,93 @@ void colorFill(PixelType *first, PixelType *last, PixelType color) {
 	}
 }
 
+template<typename PixelType>
+void colorFill(PixelType *first, PixelType *last, PixelType color) {
+	colorFillScalar<PixelType>(first, last, color);
+}
+
+#if defined(VECTOR_RENDERER_SSE2)
+
+// Spans of 16 and 32 bit pixels are filled 16 bytes at a time. Short spans
+// are left to the generic code.
+template<>
+void colorFill<uint16>(uint16 *first, uint16 *last, uint16 color) {
+	if (last - first < 16) {
+		colorFillScalar<uint16>(first, last, color);
+		return;
+	}
+
+	const __m128i v = _mm_set1_epi16(color);
+	for (; last - first >= 16; first += 16) {
+		_mm_storeu_si128((__m128i *)first, v);
+		_mm_storeu_si128((__m128i *)(first + 8), v);
+	}
+	if (last - first >= 8) {
+		_mm_storeu_si128((__m128i *)first, v);
+		first += 8;
+	}
+
+	while (first != last)
+		*first++ = color;
+}
+
+template<>
+void colorFill<uint32>(uint32 *first, uint32 *last, uint32 color) {
+	if (last - first < 8) {
+		colorFillScalar<uint32>(first, last, color);
+		return;
+	}
+
+	const __m128i v = _mm_set1_epi32(color);
+	for (; last - first >= 8; first += 8) {
+		_mm_storeu_si128((__m128i *)first, v);
+		_mm_storeu_si128((__m128i *)(first + 4), v);
+	}
+	if (last - first >= 4) {
+		_mm_storeu_si128((__m128i *)first, v);
+		first += 4;
+	}
+
+	while (first != last)
+		*first++ = color;
+}
+
+/**
+ * Blends eight 16 bit pixels at a time with a color, the same way
+ * VectorRendererSpec::blendPixelPtr() does. This only works for pixel
+ * formats without alpha and up to 6 bits per color component, where the
+ * differences of the components times alpha still fit in 16 bits.
+ *
+ * @return Pointer to the first pixel which is left to blend.
+ */
+static uint16 *blendFill16(uint16 *first, uint16 *last, uint16 color, uint8 alpha, const PixelFormat &format) {
+	const int shifts[3] = { format.rShift, format.gShift, format.bShift };
+	const int losses[3] = { format.rLoss, format.gLoss, format.bLoss };
+
+	const __m128i a = _mm_set1_epi16(alpha);
+	__m128i shift[3], bits[3], src[3];
+	for (int c = 0; c < 3; ++c) {
+		shift[c] = _mm_cvtsi32_si128(shifts[c]);
+		bits[c] = _mm_set1_epi16(0xFF >> losses[c]);
+		src[c] = _mm_set1_epi16((color >> shifts[c]) & (0xFF >> losses[c]));
+	}
+
+	for (; last - first >= 8; first += 8) {
+		const __m128i dst = _mm_loadu_si128((const __m128i *)first);
+		__m128i out = _mm_setzero_si128();
+		for (int c = 0; c < 3; ++c) {
+			const __m128i d = _mm_and_si128(_mm_srl_epi16(dst, shift[c]), bits[c]);
+			const __m128i t = _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(src[c], d), a), 8);
+			out = _mm_or_si128(out, _mm_sll_epi16(_mm_and_si128(_mm_add_epi16(d, t), bits[c]), shift[c]));
+		}
+		_mm_storeu_si128((__m128i *)first, out);
+	}
+
+	return first;
+}
+
+#endif
+
 
 VectorRenderer *createRenderer(int mode) {
 #ifdef DISABLE_FANCY_THEMES
@@ -416,6 +508,18 @@ blendPixelPtr(PixelType *ptr, PixelType color, uint8 alpha) {
                 (((int)(idst & _alphaMask) * alpha) >> 8))));
 }
 
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha) {
+#if defined(VECTOR_RENDERER_SSE2)
+	if (sizeof(PixelType) == 2 && !_alphaMask && _format.rLoss >= 2 && _format.gLoss >= 2 && _format.bLoss >= 2)
+		first = (PixelType *)blendFill16((uint16 *)first, (uint16 *)last, color, alpha, _format);
+#endif
+
+	while (first != last)
+		blendPixelPtr(first++, color, alpha);
+}
+
 template<typename PixelType>
 inline PixelType VectorRendererSpec<PixelType>::
 calcGradient(uint32 pos, uint32 max) {
@@ -1298,9 +1402,7 @@ drawSquareShadow(int x, int y, int w, int h, int blur) {
 	ptr = (PixelType *)_activeSurface->getBasePtr(x + blur, y + h - 1);
 
 	while (i++ < blur) {
-		j = w - blur;
-		while (j--)
-			blendPixelPtr(ptr + j, 0, ((blur - i) << 8) / blur);
+		blendFill(ptr, ptr + w - blur, 0, ((blur - i) << 8) / blur);
 		ptr += pitch;
 	}
 
@@ -198,9 +198,7 @@ protected:
 	 * @param color Color of the pixel
 	 * @param alpha Alpha intensity of the pixel (0-255)
 	 */
-	inline void blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha) {
-		while (first != last) blendPixelPtr(first++, color, alpha);
-	}
+	void blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha);
 
 	const PixelFormat _format;
 	const PixelType _redMask, _greenMask, _blueMask, _alphaMask;
@@ -23,14 +23,20 @@
  *
  */
 
-#include "graphics/conversion.h"
 #include "graphics/jpeg.h"
 #include "graphics/pixelformat.h"
+#include "graphics/yuv_to_rgb.h"
 
 #include "common/debug.h"
 #include "common/endian.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
+#include "common/util.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JPEG_IDCT_SSE2
+#endif
 
 namespace Graphics {
 
@@ -46,18 +52,18 @@ static const uint8 _zigZagOrder[64] = {
 	53, 60, 61, 54, 47, 55, 62, 63
 };
 
-// IDCT table built with :
-// _idct8x8[x][y] = cos(((2 * x + 1) * y) * (M_PI / 16.0)) * 0.5;
-// _idct8x8[x][y] /= sqrt(2.0) if y == 0
-static const double _idct8x8[8][8] = {
-	{ 0.353553390593274,  0.490392640201615,  0.461939766255643,  0.415734806151273,  0.353553390593274,  0.277785116509801,  0.191341716182545,  0.097545161008064 },
-	{ 0.353553390593274,  0.415734806151273,  0.191341716182545, -0.097545161008064, -0.353553390593274, -0.490392640201615, -0.461939766255643, -0.277785116509801 },
-	{ 0.353553390593274,  0.277785116509801, -0.191341716182545, -0.490392640201615, -0.353553390593274,  0.097545161008064,  0.461939766255643,  0.415734806151273 },
-	{ 0.353553390593274,  0.097545161008064, -0.461939766255643, -0.277785116509801,  0.353553390593274,  0.415734806151273, -0.191341716182545, -0.490392640201615 },
-	{ 0.353553390593274, -0.097545161008064, -0.461939766255643,  0.277785116509801,  0.353553390593274, -0.415734806151273, -0.191341716182545,  0.490392640201615 },
-	{ 0.353553390593274, -0.277785116509801, -0.191341716182545,  0.490392640201615, -0.353553390593273, -0.097545161008064,  0.461939766255643, -0.415734806151273 },
-	{ 0.353553390593274, -0.415734806151273,  0.191341716182545,  0.097545161008064, -0.353553390593274,  0.490392640201615, -0.461939766255643,  0.277785116509801 },
-	{ 0.353553390593274, -0.490392640201615,  0.461939766255643, -0.415734806151273,  0.353553390593273, -0.277785116509801,  0.191341716182545, -0.097545161008064 }
+// AAN IDCT scale factors in natural order, scaled by 2^14:
+// _idctScale[y * 8 + x] = s(y) * s(x) * 16384
+// with s(0) = 1 and s(k) = cos(k * M_PI / 16) * sqrt(2.0)
+static const uint16 _idctScale[64] = {
+	16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+	22725, 31521, 29692, 26722, 22725, 17855, 12299,  6270,
+	21407, 29692, 27969, 25172, 21407, 16819, 11585,  5906,
+	19266, 26722, 25172, 22654, 19266, 15137, 10426,  5315,
+	16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+	12873, 17855, 16819, 15137, 12873, 10114,  6967,  3552,
+	 8867, 12299, 11585, 10426,  8867,  6967,  4799,  2446,
+	 4520,  6270,  5906,  5315,  4520,  3552,  2446,  1247
 };
 
 JPEG::JPEG() :
@@ -98,16 +104,11 @@ Surface *JPEG::getSurface(const PixelFormat &format) {
 	Graphics::Surface *output = new Graphics::Surface();
 	output->create(yComponent->w, yComponent->h, format.bytesPerPixel);
 
-	for (uint16 i = 0; i < output->h; i++) {
-		for (uint16 j = 0; j < output->w; j++) {
-			byte r = 0, g = 0, b = 0;
-			YUV2RGB(*((byte *)yComponent->getBasePtr(j, i)), *((byte *)uComponent->getBasePtr(j, i)), *((byte *)vComponent->getBasePtr(j, i)), r, g, b);
-			if (format.bytesPerPixel == 2)
-				*((uint16 *)output->getBasePtr(j, i)) = format.RGBToColor(r, g, b);
-			else
-				*((uint32 *)output->getBasePtr(j, i)) = format.RGBToColor(r, g, b);
-		}
-	}
+	// The chroma components have already been scaled to the full size
+	YUVToRGB converter(format);
+	converter.convert444((byte *)output->pixels, output->pitch,
+	                     (const byte *)yComponent->pixels, (const byte *)uComponent->pixels, (const byte *)vComponent->pixels,
+	                     output->w, output->h, yComponent->pitch, uComponent->pitch);
 
 	return output;
 }
@@ -116,6 +117,7 @@ void JPEG::reset() {
 	// Reset member variables
 	_stream = NULL;
 	_w = _h = 0;
+	_restartInterval = 0;
 
 	// Free the components
 	for (int c = 0; c < _numComp; c++)
@@ -208,6 +210,9 @@ bool JPEG::read(Common::SeekableReadStream *stream) {
 		case 0xDB: // Define Quantization Tables
 			ok = readDQT();
 			break;
+		case 0xDD: // Define Restart Interval
+			ok = readDRI();
+			break;
 		case 0xE0: // JFIF/JFXX segment
 			ok = readJFIF();
 			break;
@@ -348,6 +353,29 @@ bool JPEG::readDHT() {
 			curCode++;
 			cur++;
 		}
+
+		// Fill the decoding tables
+		HuffmanTable &table = _huff[tableNum];
+		memset(table.lookup, 0, sizeof(table.lookup));
+		for (int len = 0; len <= 16; len++) {
+			table.maxCode[len] = -1;
+			table.firstIndex[len] = 0;
+		}
+
+		for (cur = 0; cur < table.count; cur++) {
+			uint8 codeSize = table.sizes[cur];
+
+			if (table.maxCode[codeSize] < 0)
+				table.firstIndex[codeSize] = cur;
+			table.maxCode[codeSize] = table.codes[cur];
+
+			// Short codes occupy all lookup entries starting with them
+			if (codeSize <= JPEG_HUFF_LOOKUP_BITS) {
+				uint8 shift = JPEG_HUFF_LOOKUP_BITS - codeSize;
+				for (int i = 0; i < (1 << shift); i++)
+					table.lookup[(table.codes[cur] << shift) | i] = (codeSize << 8) | table.values[cur];
+			}
+		}
 	}
 
 	return true;
@@ -430,7 +458,9 @@ bool JPEG::readSOS() {
 	}
 
 	// Entropy coded sequence starts, initialize Huffman decoder
+	_bitsData = 0;
 	_bitsNumber = 0;
+	_bitsMarker = false;
 
 	// Read all the scan MCUs
 	uint16 xMCU = _w / (_maxFactorH * 8);
@@ -448,9 +478,19 @@ bool JPEG::readSOS() {
 	}
 
 	bool ok = true;
-	for (int y = 0; ok && (y < yMCU); y++)
-		for (int x = 0; ok && (x < xMCU); x++)
-			ok = readMCU(x, y);
+	uint16 restartCount = _restartInterval;
+	for (int y = 0; ok && (y < yMCU); y++) {
+		for (int x = 0; ok && (x < xMCU); x++) {
+			// Resynchronize at the end of each restart interval
+			if (_restartInterval && restartCount-- == 0) {
+				ok = readRestart();
+				restartCount = _restartInterval - 1;
+			}
+
+			if (ok)
+				ok = readMCU(x, y);
+		}
+	}
 
 	// Trim Component surfaces back to image height and width
 	// Note: Code using jpeg must use surface.pitch correctly...
@@ -492,6 +532,19 @@ bool JPEG::readDQT() {
 	return true;
 }
 
+// Marker 0xDD (Define Restart Interval)
+bool JPEG::readDRI() {
+	debug(5, "JPEG: readDRI");
+	uint16 size = _stream->readUint16BE();
+	if (size != 4) {
+		warning("JPEG: Invalid restart interval size");
+		return false;
+	}
+
+	_restartInterval = _stream->readUint16BE();
+	return true;
+}
+
 bool JPEG::readMCU(uint16 xMCU, uint16 yMCU) {
 	bool ok = true;
 	for (int c = 0; ok && (c < _numComp); c++) {
@@ -507,39 +560,173 @@ bool JPEG::readMCU(uint16 xMCU, uint16 yMCU) {
 	return ok;
 }
 
-void JPEG::idct8x8(float result[64], const int16 dct[64]) {
-	float tmp[64];
+// The IDCT keeps this many fractional bits between its two passes
+#define IDCT_PASS1_BITS 2
 
-	// Apply 1D IDCT to rows
-	for (int y = 0; y < 8; y++) {
-		for (int x = 0; x < 8; x++) {
-			tmp[y + x * 8] = dct[0] * _idct8x8[x][0]
-							+ dct[1] * _idct8x8[x][1]
-							+ dct[2] * _idct8x8[x][2]
-							+ dct[3] * _idct8x8[x][3]
-							+ dct[4] * _idct8x8[x][4]
-							+ dct[5] * _idct8x8[x][5]
-							+ dct[6] * _idct8x8[x][6]
-							+ dct[7] * _idct8x8[x][7];
-		}
+// Added before the second pass, to round and level shift the output
+#define IDCT_OUTPUT_BIAS ((128 << (IDCT_PASS1_BITS + 3)) + (1 << (IDCT_PASS1_BITS + 2)))
+
+// Fractional parts of the AAN multipliers, scaled by 2^16
+#define IDCT_F_0_414 27146 // sqrt(2) - 1
+#define IDCT_F_0_152  9977 // 2 - 1.847759065
+#define IDCT_F_0_082  5400 // 1.082392200 - 1
+#define IDCT_F_0_387 25354 // 3 - 2.613125930
+
+// Arithmetic used by the IDCT passes. All variants compute the same
+// results, as every value fits in 16 bits for valid input.
+struct IDCTScalar {
+	typedef int32 Vec;
+
+	static inline Vec add(Vec a, Vec b) { return a + b; }
+	static inline Vec sub(Vec a, Vec b) { return a - b; }
+	static inline Vec mul(Vec a, int16 f) { return (a * f) >> 16; }
+};
+
+#if defined(JPEG_IDCT_SSE2)
+struct IDCTSSE2 {
+	typedef __m128i Vec;
+
+	static inline Vec add(Vec a, Vec b) { return _mm_add_epi16(a, b); }
+	static inline Vec sub(Vec a, Vec b) { return _mm_sub_epi16(a, b); }
+	static inline Vec mul(Vec a, int16 f) { return _mm_mulhi_epi16(a, _mm_set1_epi16(f)); }
+};
+
+static inline void transposeSSE2(__m128i v[8]) {
+	__m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+	__m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+	__m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+	__m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+	__m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+	__m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+	__m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+	__m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+	__m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	__m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	__m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	v[0] = _mm_unpacklo_epi64(b0, b4);
+	v[1] = _mm_unpackhi_epi64(b0, b4);
+	v[2] = _mm_unpacklo_epi64(b1, b5);
+	v[3] = _mm_unpackhi_epi64(b1, b5);
+	v[4] = _mm_unpacklo_epi64(b2, b6);
+	v[5] = _mm_unpackhi_epi64(b2, b6);
+	v[6] = _mm_unpacklo_epi64(b3, b7);
+	v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+#endif
+
+// One dimensional AAN IDCT (Arai, Agui and Nakajima), as in the "fast
+// integer" IDCT of the IJG library. The inputs are prescaled by
+// _idctScale, which leaves only five multiplications.
+template<class Ops>
+static inline void idctPass(typename Ops::Vec v[8]) {
+	typedef typename Ops::Vec Vec;
+
+	// Even part
+	Vec tmp10 = Ops::add(v[0], v[4]);
+	Vec tmp11 = Ops::sub(v[0], v[4]);
+	Vec tmp13 = Ops::add(v[2], v[6]);
+	Vec tmp12 = Ops::sub(v[2], v[6]);
+	tmp12 = Ops::sub(Ops::add(tmp12, Ops::mul(tmp12, IDCT_F_0_414)), tmp13);
+
+	Vec tmp0 = Ops::add(tmp10, tmp13);
+	Vec tmp3 = Ops::sub(tmp10, tmp13);
+	Vec tmp1 = Ops::add(tmp11, tmp12);
+	Vec tmp2 = Ops::sub(tmp11, tmp12);
+
+	// Odd part
+	Vec z13 = Ops::add(v[5], v[3]);
+	Vec z10 = Ops::sub(v[5], v[3]);
+	Vec z11 = Ops::add(v[1], v[7]);
+	Vec z12 = Ops::sub(v[1], v[7]);
+
+	Vec tmp7 = Ops::add(z11, z13);
+	Vec z = Ops::sub(z11, z13);
+	tmp11 = Ops::add(z, Ops::mul(z, IDCT_F_0_414));      // * 1.414213562
+
+	z = Ops::add(z10, z12);
+	Vec z5 = Ops::sub(Ops::add(z, z), Ops::mul(z, IDCT_F_0_152)); // * 1.847759065
+	tmp10 = Ops::sub(Ops::add(z12, Ops::mul(z12, IDCT_F_0_082)), z5); // * 1.082392200
+	z = Ops::add(Ops::add(z10, z10), z10);
+	tmp12 = Ops::add(Ops::sub(z5, z), Ops::mul(z10, IDCT_F_0_387)); // * -2.613125930
+
+	Vec tmp6 = Ops::sub(tmp12, tmp7);
+	Vec tmp5 = Ops::sub(tmp11, tmp6);
+	Vec tmp4 = Ops::add(tmp10, tmp5);
+
+	v[0] = Ops::add(tmp0, tmp7);
+	v[7] = Ops::sub(tmp0, tmp7);
+	v[1] = Ops::add(tmp1, tmp6);
+	v[6] = Ops::sub(tmp1, tmp6);
+	v[2] = Ops::add(tmp2, tmp5);
+	v[5] = Ops::sub(tmp2, tmp5);
+	v[4] = Ops::add(tmp3, tmp4);
+	v[3] = Ops::sub(tmp3, tmp4);
+}
 
-		dct += 8;
+void JPEG::idct8x8(byte *dst, int pitch, const int16 src[64]) {
+#if defined(JPEG_IDCT_SSE2)
+	// Columns are processed in parallel, with a transposition between passes
+	__m128i v[8];
+	for (int i = 0; i < 8; i++)
+		v[i] = _mm_loadu_si128((const __m128i *)(src + i * 8));
+
+	idctPass<IDCTSSE2>(v);
+	transposeSSE2(v);
+	v[0] = _mm_add_epi16(v[0], _mm_set1_epi16(IDCT_OUTPUT_BIAS));
+	idctPass<IDCTSSE2>(v);
+
+	for (int i = 0; i < 8; i++)
+		v[i] = _mm_srai_epi16(v[i], IDCT_PASS1_BITS + 3);
+	transposeSSE2(v);
+
+	for (int i = 0; i < 8; i += 2) {
+		__m128i rows = _mm_packus_epi16(v[i], v[i + 1]);
+		_mm_storel_epi64((__m128i *)(dst + i * pitch), rows);
+		_mm_storel_epi64((__m128i *)(dst + (i + 1) * pitch), _mm_srli_si128(rows, 8));
 	}
+#else
+	int32 tmp[64];
+	int32 v[8];
 
 	// Apply 1D IDCT to columns
 	for (int x = 0; x < 8; x++) {
-		const float *u = tmp + x * 8;
-		for (int y = 0; y < 8; y++) {
-			result[y * 8 + x] = u[0] * _idct8x8[y][0]
-								+ u[1] * _idct8x8[y][1]
-								+ u[2] * _idct8x8[y][2]
-								+ u[3] * _idct8x8[y][3]
-								+ u[4] * _idct8x8[y][4]
-								+ u[5] * _idct8x8[y][5]
-								+ u[6] * _idct8x8[y][6]
-								+ u[7] * _idct8x8[y][7];
+		bool dcOnly = true;
+		for (int i = 0; i < 8; i++) {
+			v[i] = src[i * 8 + x];
+			if (i && v[i])
+				dcOnly = false;
 		}
+
+		// Without AC coefficients, the whole column has the DC value
+		if (!dcOnly)
+			idctPass<IDCTScalar>(v);
+		else
+			for (int i = 1; i < 8; i++)
+				v[i] = v[0];
+
+		for (int i = 0; i < 8; i++)
+			tmp[i * 8 + x] = v[i];
 	}
+
+	// Apply 1D IDCT to rows
+	for (int y = 0; y < 8; y++) {
+		for (int i = 0; i < 8; i++)
+			v[i] = tmp[y * 8 + i];
+		v[0] += IDCT_OUTPUT_BIAS;
+
+		idctPass<IDCTScalar>(v);
+
+		for (int i = 0; i < 8; i++)
+			dst[y * pitch + i] = CLIP<int32>(v[i] >> (IDCT_PASS1_BITS + 3), 0, 255);
+	}
+#endif
 }
 
 bool JPEG::readDataUnit(uint16 x, uint16 y) {
@@ -555,31 +742,13 @@ bool JPEG::readDataUnit(uint16 x, uint16 y) {
 	// Read the AC components (stored in Zig-Zag)
 	readAC(readData);
 
-	// Calculate the DCT coefficients from the input sequence
+	// Dequantize and prescale the coefficients for the IDCT, undoing the Zig-Zag
+	const uint16 *quant = _quant[_currentComp->quantTableSelector];
 	int16 DCT[64];
 	for (uint8 i = 0; i < 64; i++) {
-		// Dequantize
-		int16 val = readData[i];
-		int16 quant = _quant[_currentComp->quantTableSelector][i];
-		val *= quant;
-
-		// Store the normalized coefficients, undoing the Zig-Zag
-		DCT[_zigZagOrder[i]] = val;
-	}
-
-	// Apply the IDCT
-	float result[64];
-	idct8x8(result, DCT);
-
-	// Level shift to make the values unsigned
-	for (int i = 0; i < 64; i++) {
-		result[i] = result[i] + 128;
-
-		if (result[i] < 0)
-			result[i] = 0;
-
-		if (result[i] > 255)
-			result[i] = 255;
+		int32 val = CLIP<int32>(readData[i] * quant[i], -32768, 32767);
+		val = (val * _idctScale[_zigZagOrder[i]] + (1 << (13 - IDCT_PASS1_BITS))) >> (14 - IDCT_PASS1_BITS);
+		DCT[_zigZagOrder[i]] = CLIP<int32>(val, -32768, 32767);
 	}
 
 	// Paint the component surface
@@ -590,6 +759,16 @@ bool JPEG::readDataUnit(uint16 x, uint16 y) {
 	x <<= 3;
 	y <<= 3;
 
+	// Without subsampling, the IDCT can write straight into the surface
+	if (scalingV == 1 && scalingH == 1) {
+		idct8x8((byte *)_currentComp->surface.getBasePtr(x, y), _currentComp->surface.pitch, DCT);
+		return true;
+	}
+
+	// Apply the IDCT
+	byte result[64];
+	idct8x8(result, 8, DCT);
+
 	for (uint8 j = 0; j < 8; j++) {
 		for (uint16 sV = 0; sV < scalingV; sV++) {
 			// Get the beginning of the block line
@@ -597,7 +776,7 @@ bool JPEG::readDataUnit(uint16 x, uint16 y) {
 
 			for (uint8 i = 0; i < 8; i++) {
 				for (uint16 sH = 0; sH < scalingH; sH++) {
-					*ptr = (byte)(result[j * 8 + i]);
+					*ptr = result[j * 8 + i];
 					ptr++;
 				}
 			}
@@ -649,12 +828,12 @@ void JPEG::readAC(int16 *out) {
 }
 
 int16 JPEG::readSignedBits(uint8 numBits) {
-	uint16 ret = 0;
 	if (numBits > 16) error("requested %d bits", numBits); //XXX
+	if (numBits == 0)
+		return 0;
 
 	// MSB=0 for negatives, 1 for positives
-	for (int i = 0; i < numBits; i++)
-		ret = (ret << 1) + readBit();
+	uint16 ret = readBits(numBits);
 
 	// Extend sign bits (PAG109)
 	if (!(ret >> (numBits - 1)))
@@ -665,62 +844,110 @@ int16 JPEG::readSignedBits(uint8 numBits) {
 	return ret;
 }
 
-// TODO: optimize?
 uint8 JPEG::readHuff(uint8 table) {
-	bool foundCode = false;
-	uint8 val = 0;
-
-	uint8 cur = 0;
-	uint8 codeSize = 1;
-	uint16 code = readBit();
-	while (!foundCode) {
-		// Prepare a code of the current size
-		while (codeSize < _huff[table].sizes[cur]) {
-			code = (code << 1) + readBit();
-			codeSize++;
-		}
+	HuffmanTable &huff = _huff[table];
 
-		// Compare the codes of the current size
-		while (!foundCode && (codeSize == _huff[table].sizes[cur])) {
-			if (code == _huff[table].codes[cur]) {
-				// Found the code
-				val = _huff[table].values[cur];
-				foundCode = true;
-			} else {
-				// Continue reading
-				cur++;
-			}
-		}
+	if (_bitsNumber < JPEG_HUFF_LOOKUP_BITS)
+		fillBits();
+
+	// Most codes are short enough to be found with a single lookup
+	uint16 code = (_bitsData >> (_bitsNumber - JPEG_HUFF_LOOKUP_BITS)) & ((1 << JPEG_HUFF_LOOKUP_BITS) - 1);
+	uint16 entry = huff.lookup[code];
+	if (entry) {
+		_bitsNumber -= entry >> 8;
+		return entry & 0xFF;
 	}
 
-	return val;
+	// Extend longer codes bit by bit
+	_bitsNumber -= JPEG_HUFF_LOOKUP_BITS;
+	for (uint8 codeSize = JPEG_HUFF_LOOKUP_BITS + 1; codeSize <= 16; codeSize++) {
+		code = (code << 1) | readBit();
+
+		if ((int32)code <= huff.maxCode[codeSize])
+			return huff.values[huff.firstIndex[codeSize] + code - huff.codes[huff.firstIndex[codeSize]]];
+	}
+
+	warning("JPEG: Invalid Huffman code");
+	return 0;
 }
 
-uint8 JPEG::readBit() {
-	// Read a whole byte if necessary
-	if (_bitsNumber == 0) {
-		_bitsData = _stream->readByte();
-		_bitsNumber = 8;
-
-		// Detect markers
-		if (_bitsData == 0xFF) {
-			uint8 byte2 = _stream->readByte();
-
-			// A stuffed 0 validates the previous byte
-			if (byte2 != 0) {
-				if (byte2 == 0xDC) {
-					// DNL marker: Define Number of Lines
-					// TODO: terminate scan
-					printf("DNL marker detected: terminate scan\n");
-				} else {
-					printf("Error: marker 0x%02X read in entropy data\n", byte2);
+void JPEG::fillBits() {
+	// Keep at least 16 bits buffered, enough for any code or value
+	while (_bitsNumber <= 24) {
+		uint8 data = 0;
+
+		// After a marker, only zero bits are left in the scan
+		if (!_bitsMarker) {
+			data = _stream->readByte();
+
+			// Detect markers
+			if (data == 0xFF) {
+				uint8 byte2 = _stream->readByte();
+
+				// A stuffed 0 validates the previous byte
+				if (byte2 != 0) {
+					if (byte2 == 0xDC) {
+						// DNL marker: Define Number of Lines
+						// TODO: terminate scan
+						debug(3, "JPEG: DNL marker detected: terminate scan");
+					}
+
+					// Leave the marker in the stream for read()
+					_stream->seek(-2, SEEK_CUR);
+					_bitsMarker = true;
+					data = 0;
 				}
 			}
 		}
+
+		_bitsData = (_bitsData << 8) | data;
+		_bitsNumber += 8;
 	}
+}
+
+uint16 JPEG::readBits(uint8 numBits) {
+	if (_bitsNumber < numBits)
+		fillBits();
+
+	_bitsNumber -= numBits;
+	return (_bitsData >> _bitsNumber) & ((1 << numBits) - 1);
+}
+
+uint8 JPEG::readBit() {
+	if (_bitsNumber == 0)
+		fillBits();
+
 	_bitsNumber--;
+	return (_bitsData >> _bitsNumber) & 1;
+}
+
+bool JPEG::readRestart() {
+	// Drop the padding bits of the previous interval
+	_bitsData = 0;
+	_bitsNumber = 0;
+	_bitsMarker = false;
+
+	// Find the next marker, which should be RST0-RST7
+	uint8 marker = 0;
+	while (marker == 0 && !_stream->eos()) {
+		if (_stream->readByte() != 0xFF)
+			continue;
 
-	return (_bitsData & (1 << _bitsNumber)) ? 1 : 0;
+		marker = _stream->readByte();
+		while (marker == 0xFF && !_stream->eos())
+			marker = _stream->readByte();
+	}
+
+	if (marker < 0xD0 || marker > 0xD7) {
+		warning("JPEG: Missing restart marker");
+		return false;
+	}
+
+	// The DC predictors start from scratch after each marker
+	for (int c = 0; c < _numScanComp; c++)
+		_scanComp[c]->DCpredictor = 0;
+
+	return true;
 }
 
 Surface *JPEG::getComponent(uint c) {
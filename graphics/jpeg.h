@@ -38,6 +38,7 @@ struct PixelFormat;
 
 #define JPEG_MAX_QUANT_TABLES 4
 #define JPEG_MAX_HUFF_TABLES 2
+#define JPEG_HUFF_LOOKUP_BITS 9
 
 class JPEG {
 public:
@@ -87,6 +88,9 @@ private:
 	uint8 _maxFactorV;
 	uint8 _maxFactorH;
 
+	// Number of MCUs between restart markers, 0 if there are none
+	uint16 _restartInterval;
+
 	// Quantization tables
 	uint16 *_quant[JPEG_MAX_QUANT_TABLES];
 
@@ -96,6 +100,14 @@ private:
 		uint8 *values;
 		uint8 *sizes;
 		uint16 *codes;
+
+		// Indexed by the next JPEG_HUFF_LOOKUP_BITS bits: the code size
+		// (shifted by 8) and value of codes that fit, 0 for longer codes
+		uint16 lookup[1 << JPEG_HUFF_LOOKUP_BITS];
+
+		// Largest code and index of the first code of each size, or -1
+		int32 maxCode[17];
+		int16 firstIndex[17];
 	} _huff[2 * JPEG_MAX_HUFF_TABLES];
 
 	// Marker read functions
@@ -104,6 +116,7 @@ private:
 	bool readDHT();
 	bool readSOS();
 	bool readDQT();
+	bool readDRI();
 
 	// Helper functions
 	bool readMCU(uint16 xMCU, uint16 yMCU);
@@ -115,11 +128,15 @@ private:
 	// Huffman decoding
 	uint8 readHuff(uint8 table);
 	uint8 readBit();
-	uint8 _bitsData;
+	bool readRestart();
+	uint16 readBits(uint8 numBits);
+	void fillBits();
+	uint32 _bitsData;
 	uint8 _bitsNumber;
+	bool _bitsMarker;
 
 	// Inverse Discrete Cosine Transformation
-	void idct8x8(float dst[64], const int16 src[64]);
+	void idct8x8(byte *dst, int pitch, const int16 src[64]);
 };
 
 } // End of Graphics namespace
@@ -0,0 +1,197 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "graphics/yuv_to_rgb.h"
+
+#include "common/endian.h"
+#include "common/util.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define YUV_TO_RGB_SSE2
+#endif
+
+namespace Graphics {
+
+YUVToRGB::YUVToRGB(const PixelFormat &format, ColorSpace colorSpace) : _format(format), _colorSpace(colorSpace) {
+	for (int i = 0; i < 256; i++) {
+		const int c = i - 128;
+
+		switch (colorSpace) {
+		case kColorSpaceCinepak:
+			_rV[i] = 2 * c;
+			_gU[i] = c / 2;
+			_gV[i] = c;
+			_bU[i] = 2 * c;
+			break;
+
+		case kColorSpaceMPEG:
+			// Truncated, just like the tables of mpeg_play
+			_rV[i] =  (int16)( (0.419 / 0.299) * c);
+			_gU[i] = -(int16)(-(0.114 / 0.331) * c);
+			_gV[i] = -(int16)(-(0.299 / 0.419) * c);
+			_bU[i] =  (int16)( (0.587 / 0.331) * c);
+			break;
+
+		default:
+			_rV[i] = (1357 * c) >> 10;
+			_gU[i] = ( 333 * c) >> 10;
+			_gV[i] = ( 691 * c) >> 10;
+			_bU[i] = (1715 * c) >> 10;
+			break;
+		}
+
+		_colorR[i] = format.RGBToColor(i, 0, 0);
+		_colorG[i] = (i >> format.gLoss) << format.gShift;
+		_colorB[i] = (i >> format.bLoss) << format.bShift;
+	}
+}
+
+template<int chromaShift>
+void YUVToRGB::convertLineTemplate(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width) const {
+	const uint bpp = _format.bytesPerPixel;
+	int x = 0;
+
+	// The chroma is pre-shifted, so the upper half of the 16 bit products
+	// is exactly the ">> 10" of YUV2RGB. Clipping is done by the
+	// saturating narrowing to 8 bits.
+#if defined(YUV_TO_RGB_SSE2)
+	if (_colorSpace == kColorSpaceDefault && (bpp == 2 || bpp == 4)) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(128);
+		const __m128i kRV  = _mm_set1_epi16(1357);
+		const __m128i kGV  = _mm_set1_epi16(691);
+		const __m128i kGU  = _mm_set1_epi16(333);
+		const __m128i kBU  = _mm_set1_epi16(1715);
+		const __m128i rLoss = _mm_cvtsi32_si128(_format.rLoss);
+		const __m128i gLoss = _mm_cvtsi32_si128(_format.gLoss);
+		const __m128i bLoss = _mm_cvtsi32_si128(_format.bLoss);
+		const __m128i rShift = _mm_cvtsi32_si128(_format.rShift);
+		const __m128i gShift = _mm_cvtsi32_si128(_format.gShift);
+		const __m128i bShift = _mm_cvtsi32_si128(_format.bShift);
+		const uint32 alpha = (0xFF >> _format.aLoss) << _format.aShift;
+
+		for (; x + 8 <= width; x += 8) {
+			__m128i u, v;
+			if (chromaShift == 0) {
+				u = _mm_loadl_epi64((const __m128i *)(uSrc + x));
+				v = _mm_loadl_epi64((const __m128i *)(vSrc + x));
+			} else if (chromaShift == 1) {
+				u = _mm_cvtsi32_si128(READ_UINT32(uSrc + (x >> 1)));
+				v = _mm_cvtsi32_si128(READ_UINT32(vSrc + (x >> 1)));
+				u = _mm_unpacklo_epi8(u, u);
+				v = _mm_unpacklo_epi8(v, v);
+			} else {
+				u = _mm_cvtsi32_si128(READ_UINT16(uSrc + (x >> 2)));
+				v = _mm_cvtsi32_si128(READ_UINT16(vSrc + (x >> 2)));
+				u = _mm_unpacklo_epi8(u, u);
+				v = _mm_unpacklo_epi8(v, v);
+				u = _mm_unpacklo_epi8(u, u);
+				v = _mm_unpacklo_epi8(v, v);
+			}
+
+			const __m128i cY = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero);
+			const __m128i cU = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(u, zero), bias), 6);
+			const __m128i cV = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(v, zero), bias), 6);
+
+			__m128i r = _mm_add_epi16(cY, _mm_mulhi_epi16(cV, kRV));
+			__m128i g = _mm_sub_epi16(_mm_sub_epi16(cY, _mm_mulhi_epi16(cV, kGV)), _mm_mulhi_epi16(cU, kGU));
+			__m128i b = _mm_add_epi16(cY, _mm_mulhi_epi16(cU, kBU));
+			r = _mm_srl_epi16(_mm_unpacklo_epi8(_mm_packus_epi16(r, r), zero), rLoss);
+			g = _mm_srl_epi16(_mm_unpacklo_epi8(_mm_packus_epi16(g, g), zero), gLoss);
+			b = _mm_srl_epi16(_mm_unpacklo_epi8(_mm_packus_epi16(b, b), zero), bLoss);
+
+			if (bpp == 2) {
+				const __m128i color = _mm_or_si128(_mm_set1_epi16((int16)alpha),
+					_mm_or_si128(_mm_sll_epi16(r, rShift), _mm_or_si128(_mm_sll_epi16(g, gShift), _mm_sll_epi16(b, bShift))));
+				_mm_storeu_si128((__m128i *)(dst + x * 2), color);
+			} else {
+				const __m128i a32 = _mm_set1_epi32(alpha);
+				const __m128i lo = _mm_or_si128(a32, _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rShift),
+					_mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gShift), _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bShift))));
+				const __m128i hi = _mm_or_si128(a32, _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rShift),
+					_mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gShift), _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bShift))));
+				_mm_storeu_si128((__m128i *)(dst + x * 4), lo);
+				_mm_storeu_si128((__m128i *)(dst + x * 4 + 16), hi);
+			}
+		}
+	}
+#endif
+
+	for (; x < width; x++) {
+		const int cY = ySrc[x];
+		const byte cU = uSrc[x >> chromaShift];
+		const byte cV = vSrc[x >> chromaShift];
+
+		const uint32 color =
+			_colorR[CLIP<int>(cY + _rV[cV], 0, 255)] |
+			_colorG[CLIP<int>(cY - _gV[cV] - _gU[cU], 0, 255)] |
+			_colorB[CLIP<int>(cY + _bU[cU], 0, 255)];
+
+		if      (bpp == 1)
+			dst[x] = (uint8)color;
+		else if (bpp == 2)
+			*((uint16 *)(dst + x * 2)) = (uint16)color;
+		else if (bpp == 4)
+			*((uint32 *)(dst + x * 4)) = color;
+	}
+}
+
+template<int chromaShift>
+void YUVToRGB::convertTemplate(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+                               int width, int height, int yPitch, int uvPitch) const {
+	for (int y = 0; y < height; y++) {
+		convertLineTemplate<chromaShift>(dst, ySrc, uSrc, vSrc, width);
+
+		dst  += dstPitch;
+		ySrc += yPitch;
+
+		if (((y + 1) & ((1 << chromaShift) - 1)) == 0) {
+			uSrc += uvPitch;
+			vSrc += uvPitch;
+		}
+	}
+}
+
+void YUVToRGB::convertLine(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width) const {
+	convertLineTemplate<0>(dst, ySrc, uSrc, vSrc, width);
+}
+
+void YUVToRGB::convert444(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+                          int width, int height, int yPitch, int uvPitch) const {
+	convertTemplate<0>(dst, dstPitch, ySrc, uSrc, vSrc, width, height, yPitch, uvPitch);
+}
+
+void YUVToRGB::convert420(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+                          int width, int height, int yPitch, int uvPitch) const {
+	convertTemplate<1>(dst, dstPitch, ySrc, uSrc, vSrc, width, height, yPitch, uvPitch);
+}
+
+void YUVToRGB::convert410(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+                          int width, int height, int yPitch, int uvPitch) const {
+	convertTemplate<2>(dst, dstPitch, ySrc, uSrc, vSrc, width, height, yPitch, uvPitch);
+}
+
+} // End of namespace Graphics
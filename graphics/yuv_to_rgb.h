@@ -0,0 +1,114 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_H
+#define GRAPHICS_YUV_TO_RGB_H
+
+#include "common/scummsys.h"
+#include "graphics/pixelformat.h"
+
+namespace Graphics {
+
+/**
+ * Converts planar YUV images into RGB pixels of a given format.
+ *
+ * Conversion is table driven. For the default color space, SSE2 builds
+ * convert 8 pixels at a time instead. All paths produce exactly the
+ * same output as YUV2RGB followed by PixelFormat::RGBToColor.
+ */
+class YUVToRGB {
+public:
+	/** The formula used to convert a pixel. */
+	enum ColorSpace {
+		kColorSpaceDefault,	///< The formula of YUV2RGB
+		kColorSpaceCinepak,	///< The simplified formula of Cinepak
+		kColorSpaceMPEG		///< The formula of the Berkeley mpeg_play
+	};
+
+	/**
+	 * Sets up the conversion into pixels of the given format, which may
+	 * have 1, 2 or 4 bytes per pixel.
+	 */
+	YUVToRGB(const PixelFormat &format, ColorSpace colorSpace = kColorSpaceDefault);
+
+	const PixelFormat &getFormat() const { return _format; }
+
+	/**
+	 * Converts a line with one U and V sample for every pixel.
+	 */
+	void convertLine(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width) const;
+
+	/**
+	 * Converts an image with full resolution chroma.
+	 *
+	 * @param dst		destination pixels
+	 * @param dstPitch	width in bytes of one line of the destination
+	 * @param yPitch	width in bytes of one line of the Y plane
+	 * @param uvPitch	width in bytes of one line of the U and V planes
+	 */
+	void convert444(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+	                int width, int height, int yPitch, int uvPitch) const;
+
+	/**
+	 * Converts an image with chroma of half the width and height.
+	 * @see convert444
+	 */
+	void convert420(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+	                int width, int height, int yPitch, int uvPitch) const;
+
+	/**
+	 * Converts an image with chroma of a quarter of the width and height.
+	 * Chroma is not interpolated.
+	 * @see convert444
+	 */
+	void convert410(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+	                int width, int height, int yPitch, int uvPitch) const;
+
+private:
+	PixelFormat _format;
+	ColorSpace _colorSpace;
+
+	// Chroma contributions to the color channels
+	int16 _rV[256];
+	int16 _gU[256];
+	int16 _gV[256];
+	int16 _bU[256];
+
+	// Color channel values in the pixel format, alpha is part of red
+	uint32 _colorR[256];
+	uint32 _colorG[256];
+	uint32 _colorB[256];
+
+	template<int chromaShift>
+	void convertLineTemplate(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width) const;
+
+	template<int chromaShift>
+	void convertTemplate(byte *dst, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+	                     int width, int height, int yPitch, int uvPitch) const;
+};
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_YUV_TO_RGB_H
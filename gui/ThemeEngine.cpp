@@ -25,8 +25,12 @@
 
 #include "common/system.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
 #include "common/unzip.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -72,6 +76,9 @@ struct WidgetDrawData {
 
 	bool _buffer;
 
+	/** Whether drawing this widget only depends on its size and background */
+	bool _cacheable;
+
 
 	/**
 	 * Calculates the background threshold offset of a given DrawData item.
@@ -81,6 +88,13 @@ struct WidgetDrawData {
 	 * value will be added when restoring the background of the widget.
 	 */
 	void calcBackgroundOffset();
+
+	/**
+	 * Checks whether the DrawSteps of a DrawData item set all the colors
+	 * they use, and only draw inside the item, so that the widget cache can
+	 * keep the result. Must be called after fully loading the DrawSteps.
+	 */
+	void calcCacheable();
 };
 
 class ThemeItem {
@@ -219,11 +233,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawWidget(_data, _area, extendedRect, _dynamicData);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -270,6 +281,9 @@ ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 
 	_useCursor = false;
 
+	_widgetCacheUsed = 0;
+	_widgetCacheHits = _widgetCacheMisses = 0;
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		_widgets[i] = 0;
 	}
@@ -303,6 +317,7 @@ ThemeEngine::~ThemeEngine() {
 	_screen.free();
 	_backBuffer.free();
 
+	clearWidgetCache();
 	unloadTheme();
 
 	// Release all graphics surfaces
@@ -505,6 +520,8 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	delete _vectorRenderer;
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
+
+	clearWidgetCache();
 }
 
 void WidgetDrawData::calcBackgroundOffset() {
@@ -521,11 +538,145 @@ void WidgetDrawData::calcBackgroundOffset() {
 	_backgroundOffset = maxShadow;
 }
 
+void WidgetDrawData::calcCacheable() {
+	_cacheable = true;
+
+	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
+	        step != _steps.end(); ++step) {
+		const Graphics::DrawingFunctionCallback call = step->drawingCall;
+
+		if (call == &Graphics::VectorRenderer::drawCallback_BITMAP ||
+			call == &Graphics::VectorRenderer::drawCallback_VOID)
+			continue;
+
+		// Colors which are not set are left over from earlier drawing
+		bool colorsSet = step->fgColor.set;
+		if (step->fillMode == Graphics::VectorRenderer::kFillBackground || call == &Graphics::VectorRenderer::drawCallback_BEVELSQ)
+			colorsSet = colorsSet && step->bgColor.set;
+		if (step->fillMode == Graphics::VectorRenderer::kFillGradient)
+			colorsSet = colorsSet && step->gradColor1.set && step->gradColor2.set;
+		if (step->bevel > 0 || call == &Graphics::VectorRenderer::drawCallback_BEVELSQ)
+			colorsSet = colorsSet && step->bevelColor.set;
+
+		if (!colorsSet || call == &Graphics::VectorRenderer::drawCallback_FILLSURFACE) {
+			_cacheable = false;
+			return;
+		}
+	}
+}
+
 void ThemeEngine::restoreBackground(Common::Rect r) {
 	r.clip(_screen.w, _screen.h);
 	_vectorRenderer->blitSurface(&_backBuffer, r);
 }
 
+static uint32 hashArea(const Graphics::Surface *surface, const Common::Rect &r) {
+	// FNV-1a over the (16 bit) pixels
+	uint32 hash = 2166136261u;
+	for (int y = r.top; y < r.bottom; ++y) {
+		const uint16 *src = (const uint16 *)surface->getBasePtr(r.left, y);
+		for (int x = r.width(); x > 0; --x)
+			hash = (hash ^ *src++) * 16777619;
+	}
+	return hash;
+}
+
+static bool compareArea(const Graphics::Surface *surface, const Common::Rect &r, const byte *data) {
+	const int rowSize = r.width() * surface->bytesPerPixel;
+	for (int y = r.top; y < r.bottom; ++y, data += rowSize) {
+		if (memcmp(surface->getBasePtr(r.left, y), data, rowSize))
+			return false;
+	}
+	return true;
+}
+
+static void copyFromArea(const Graphics::Surface *surface, const Common::Rect &r, byte *data) {
+	const int rowSize = r.width() * surface->bytesPerPixel;
+	for (int y = r.top; y < r.bottom; ++y, data += rowSize)
+		memcpy(data, surface->getBasePtr(r.left, y), rowSize);
+}
+
+static void copyToArea(Graphics::Surface *surface, const Common::Rect &r, const byte *data) {
+	const int rowSize = r.width() * surface->bytesPerPixel;
+	for (int y = r.top; y < r.bottom; ++y, data += rowSize)
+		memcpy(surface->getBasePtr(r.left, y), data, rowSize);
+}
+
+void ThemeEngine::drawWidget(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &extendedArea, uint32 dynamicData) {
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	Graphics::Surface *surface = _vectorRenderer->getSurface();
+	const uint32 size = extendedArea.width() * extendedArea.height() * surface->bytesPerPixel;
+
+	// The renderer leaves out shadows touching the edges of the surface,
+	// so only widgets well inside of it look the same wherever they are.
+	// Widgets too big to be kept along with some others are not cached.
+	if (!data->_cacheable || extendedArea.left < 0 || extendedArea.top < 0 ||
+		extendedArea.right >= surface->w || extendedArea.bottom >= surface->h ||
+		size * 2 > kWidgetCacheSize / 4) {
+		for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+			_vectorRenderer->drawStep(area, *step, dynamicData);
+		return;
+	}
+
+	CachedWidget widget;
+	widget.data = data;
+	widget.dynamicData = dynamicData;
+	widget.shadows = _vectorRenderer->shadowsEnabled();
+	widget.width = extendedArea.width();
+	widget.height = extendedArea.height();
+	widget.hash = hashArea(surface, extendedArea);
+
+	for (Common::List<CachedWidget>::iterator i = _widgetCache.begin(); i != _widgetCache.end(); ++i) {
+		if (i->data == widget.data && i->dynamicData == widget.dynamicData && i->shadows == widget.shadows &&
+			i->width == widget.width && i->height == widget.height && i->hash == widget.hash &&
+			compareArea(surface, extendedArea, i->background)) {
+			copyToArea(surface, extendedArea, i->pixels);
+
+			// Leave the renderer set up like drawing the steps does
+			for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+				_vectorRenderer->setupStep(*step, dynamicData);
+
+			widget = *i;
+			_widgetCache.erase(i);
+			_widgetCache.push_front(widget);
+			_widgetCacheHits++;
+			return;
+		}
+	}
+
+	_widgetCacheMisses++;
+
+	widget.background = new byte[size];
+	copyFromArea(surface, extendedArea, widget.background);
+
+	for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+		_vectorRenderer->drawStep(area, *step, dynamicData);
+
+	widget.pixels = new byte[size];
+	copyFromArea(surface, extendedArea, widget.pixels);
+
+	_widgetCache.push_front(widget);
+	_widgetCacheUsed += size * 2;
+
+	// Drop the least recently used widgets
+	while (_widgetCacheUsed > kWidgetCacheSize) {
+		const CachedWidget &last = _widgetCache.back();
+		_widgetCacheUsed -= last.width * last.height * surface->bytesPerPixel * 2;
+		delete[] last.background;
+		delete[] last.pixels;
+		_widgetCache.pop_back();
+	}
+}
+
+void ThemeEngine::clearWidgetCache() {
+	for (Common::List<CachedWidget>::iterator i = _widgetCache.begin(); i != _widgetCache.end(); ++i) {
+		delete[] i->background;
+		delete[] i->pixels;
+	}
+	_widgetCache.clear();
+	_widgetCacheUsed = 0;
+}
+
 
 
 /**********************************************************
@@ -645,12 +796,15 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 	if (id == -1)
 		return false;
 
-	if (_widgets[id] != 0)
+	if (_widgets[id] != 0) {
+		clearWidgetCache();
 		delete _widgets[id];
+	}
 
 	_widgets[id] = new WidgetDrawData;
 	_widgets[id]->_buffer = kDrawDataDefaults[id].buffer;
 	_widgets[id]->_textDataId = kTextDataNone;
+	_widgets[id]->_cacheable = false;
 
 	return true;
 }
@@ -679,6 +833,7 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 			warning("Missing data asset: '%s'", kDrawDataDefaults[i].name);
 		} else {
 			_widgets[i]->calcBackgroundOffset();
+			_widgets[i]->calcCacheable();
 		}
 	}
 }
@@ -687,6 +842,8 @@ void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	clearWidgetCache();
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = 0;
@@ -706,6 +863,174 @@ void ThemeEngine::unloadTheme() {
 	_themeOk = false;
 }
 
+/**********************************************************
+ * Compiled theme cache
+ *********************************************************/
+
+// The STX files of each theme are kept in a save file in the form
+// XMLParser::setCompiledOutput() produces, along with the MD5 of their
+// source. Loading the theme replays the compiled data of every file whose
+// source did not change, and only tokenizes the others. The compiled data
+// does not depend on the overlay resolution, so it is valid for all of them.
+static const uint32 kThemeCacheTag = MKTAG('S','T','X','C');
+static const uint32 kThemeCacheVersion = 1;
+
+struct ThemeSource {
+	Common::String name;
+	byte *data;
+	uint32 size;
+	uint8 md5[16];
+
+	byte *compiled;
+	uint32 compiledSize;
+
+	ThemeSource() : data(0), size(0), compiled(0), compiledSize(0) {}
+	ThemeSource(const Common::String &n, byte *d, uint32 s) : name(n), data(d), size(s), compiled(0), compiledSize(0) {
+		Common::MemoryReadStream stream(data, size);
+		Common::computeStreamMD5(stream, md5);
+	}
+};
+
+typedef Common::Array<ThemeSource> ThemeSourceArray;
+
+static void freeThemeSources(ThemeSourceArray &sources) {
+	for (ThemeSourceArray::iterator i = sources.begin(); i != sources.end(); ++i) {
+		free(i->data);
+		free(i->compiled);
+	}
+	sources.clear();
+}
+
+static Common::String getThemeCacheFile(const Common::String &themeId) {
+	return themeId + ".stc";
+}
+
+static void readThemeCache(const Common::String &cacheFile, ThemeSourceArray &sources) {
+	// Themes are shared by all games, so the cache must stay in the save
+	// path of the application while a game domain is active
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::SeekableReadStream *stream = saveFileMan ? saveFileMan->openGlobalForLoading(cacheFile) : 0;
+	if (!stream)
+		return;
+
+	if (stream->readUint32BE() != kThemeCacheTag || stream->readUint32BE() != kThemeCacheVersion) {
+		delete stream;
+		return;
+	}
+
+	for (uint32 count = stream->readUint32BE(); count > 0 && !stream->eos(); --count) {
+		Common::String name = stream->readLine();
+		uint8 md5[16];
+		stream->read(md5, sizeof(md5));
+		const uint32 size = stream->readUint32BE();
+
+		// A size beyond the end of the file means the cache is damaged,
+		// and nothing after this entry can be trusted either
+		if (stream->eos() || stream->err() || size > (uint32)(stream->size() - stream->pos()))
+			break;
+
+		ThemeSourceArray::iterator i;
+		for (i = sources.begin(); i != sources.end(); ++i) {
+			if (i->name == name && !i->compiled && !memcmp(i->md5, md5, sizeof(md5)))
+				break;
+		}
+
+		if (i == sources.end()) {
+			stream->skip(size);
+			continue;
+		}
+
+		i->compiled = (byte *)malloc(size);
+		if (!i->compiled)
+			break;
+		i->compiledSize = size;
+		if (stream->read(i->compiled, size) != size) {
+			free(i->compiled);
+			i->compiled = 0;
+			i->compiledSize = 0;
+			break;
+		}
+	}
+
+	delete stream;
+}
+
+static void writeThemeCache(const Common::String &cacheFile, const ThemeSourceArray &sources) {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::WriteStream *stream = saveFileMan ? saveFileMan->openGlobalForSaving(cacheFile) : 0;
+	if (!stream) {
+		warning("Could not write the theme cache '%s'", cacheFile.c_str());
+		return;
+	}
+
+	stream->writeUint32BE(kThemeCacheTag);
+	stream->writeUint32BE(kThemeCacheVersion);
+	stream->writeUint32BE(sources.size());
+
+	for (ThemeSourceArray::const_iterator i = sources.begin(); i != sources.end(); ++i) {
+		stream->writeString(i->name);
+		stream->writeByte('\n');
+		stream->write(i->md5, sizeof(i->md5));
+		stream->writeUint32BE(i->compiledSize);
+		stream->write(i->compiled, i->compiledSize);
+	}
+
+	stream->finalize();
+	if (stream->err())
+		warning("Could not write the theme cache '%s'", cacheFile.c_str());
+	delete stream;
+}
+
+static bool parseThemeSources(ThemeParser *parser, const Common::String &themeId, ThemeSourceArray &sources) {
+	const Common::String cacheFile = getThemeCacheFile(themeId);
+	const uint32 start = g_system->getMillis();
+	int compiled = 0;
+
+	readThemeCache(cacheFile, sources);
+
+	for (ThemeSourceArray::iterator i = sources.begin(); i != sources.end(); ++i) {
+		if (i->compiled) {
+			parser->loadBuffer(i->compiled, i->compiledSize);
+			const bool result = parser->parseCompiled();
+			parser->close();
+
+			if (result) {
+				compiled++;
+				continue;
+			}
+
+			// Whatever the broken data did define is overwritten by
+			// parsing the source, which also replaces it in the cache
+			warning("Ignoring the cached form of STX file '%s'", i->name.c_str());
+			free(i->compiled);
+			i->compiled = 0;
+			i->compiledSize = 0;
+		}
+
+		Common::MemoryWriteStreamDynamic output;
+		parser->setCompiledOutput(&output);
+		parser->loadBuffer(i->data, i->size);
+		bool result = parser->parse();
+		parser->setCompiledOutput(0);
+		parser->close();
+
+		i->compiled = output.getData();
+		i->compiledSize = output.size();
+
+		if (!result) {
+			warning("Failed to parse STX file '%s'", i->name.c_str());
+			return false;
+		}
+	}
+
+	if (compiled < (int)sources.size())
+		writeThemeCache(cacheFile, sources);
+
+	debug(2, "Loaded theme '%s' in %d ms, %d of %d STX files were compiled", themeId.c_str(),
+	      g_system->getMillis() - start, compiled, sources.size());
+	return true;
+}
+
 bool ThemeEngine::loadDefaultXML() {
 
 	// The default XML theme is included on runtime from a pregenerated
@@ -717,15 +1042,19 @@ bool ThemeEngine::loadDefaultXML() {
 #include "themes/default.inc"
 	    ;
 
-	if (!_parser->loadBuffer((const byte *)defaultXML, strlen(defaultXML)))
-		return false;
-
 	_themeName = "ScummVM Classic Theme (Builtin Version)";
 	_themeId = "builtin";
 	_themeFile.clear();
 
-	bool result = _parser->parse();
-	_parser->close();
+	const uint32 size = strlen(defaultXML);
+	byte *data = (byte *)malloc(size);
+	memcpy(data, defaultXML, size);
+
+	ThemeSourceArray sources;
+	sources.push_back(ThemeSource("default.inc", data, size));
+
+	bool result = parseThemeSources(_parser, _themeId, sources);
+	freeThemeSources(sources);
 
 	return result;
 #else
@@ -764,28 +1093,31 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 	}
 
 	//
-	// Loop over all STX files, load and parse them
+	// Load all STX files, then parse them or use their compiled form
 	//
+	ThemeSourceArray sources;
 	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
 		assert((*i)->getName().hasSuffix(".stx"));
 
-		if (_parser->loadStream((*i)->createReadStream()) == false) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		byte *data = stream ? (byte *)malloc(stream->size()) : 0;
+		if (!stream || stream->read(data, stream->size()) != (uint32)stream->size()) {
 			warning("Failed to load STX file '%s'", (*i)->getDisplayName().c_str());
-			_parser->close();
-			return false;
-		}
-
-		if (_parser->parse() == false) {
-			warning("Failed to parse STX file '%s'", (*i)->getDisplayName().c_str());
-			_parser->close();
+			free(data);
+			delete stream;
+			freeThemeSources(sources);
 			return false;
 		}
 
-		_parser->close();
+		sources.push_back(ThemeSource((*i)->getName(), data, stream->size()));
+		delete stream;
 	}
 
-	assert(!_themeName.empty());
-	return true;
+	bool result = parseThemeSources(_parser, _themeId, sources);
+	freeThemeSources(sources);
+
+	assert(!result || !_themeName.empty());
+	return result;
 }
 
 
@@ -1261,6 +1593,9 @@ void ThemeEngine::renderDirtyScreen() {
 }
 
 void ThemeEngine::openDialog(bool doBuffer, ShadingStyle style) {
+	debug(2, "Widget cache: %d hits, %d misses, %d widgets using %d KB", _widgetCacheHits, _widgetCacheMisses,
+		_widgetCache.size(), _widgetCacheUsed / 1024);
+
 	if (doBuffer)
 		_buffering = true;
 
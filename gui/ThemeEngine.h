@@ -502,6 +502,18 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Draws the steps of a DrawData item on the active drawing surface.
+	 * The result is kept in the widget cache, and copied back the next
+	 * time the item is drawn with the same size on the same background.
+	 *
+	 * @param data DrawData item to draw.
+	 * @param area Area of the item.
+	 * @param extendedArea Area touched when drawing the item, i.e. including its shadows.
+	 * @param dynamicData Dynamic data passed on to the draw steps.
+	 */
+	void drawWidget(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &extendedArea, uint32 dynamicData);
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -653,6 +665,30 @@ protected:
 	/** Queue with all the drawing that must be done to the screen */
 	Common::List<ThemeItem *> _screenQueue;
 
+	enum {
+		/** Bytes of pixel data the widget cache may hold */
+		kWidgetCacheSize = 1024 * 1024
+	};
+
+	/** A widget drawn on the given background, as found in the widget cache */
+	struct CachedWidget {
+		const WidgetDrawData *data;
+		uint32 dynamicData;
+		bool shadows;
+		int16 width, height;	///< Size of the extended area of the widget
+		uint32 hash;			///< Hash of the background pixels
+
+		byte *background;		///< The extended area before drawing the widget
+		byte *pixels;			///< The extended area after drawing the widget
+	};
+
+	/** Rendered widgets, the most recently used first */
+	Common::List<CachedWidget> _widgetCache;
+	uint32 _widgetCacheUsed;
+	uint32 _widgetCacheHits, _widgetCacheMisses;
+
+	void clearWidgetCache();
+
 	bool _initOk;  ///< Class and renderer properly initialized
 	bool _themeOk; ///< Theme data successfully loaded.
 	bool _enabled; ///< Whether the Theme is currently shown on the overlay
@@ -31,6 +31,8 @@
 
 #include "engines/engine.h"
 
+#include "base/benchmark.h"
+
 #include "gui/debugger.h"
 #ifndef USE_TEXT_CONSOLE
 	#include "gui/console.h"
@@ -66,6 +68,8 @@ Debugger::Debugger() {
 	DCmd_Register("debugflag_list",		WRAP_METHOD(Debugger, Cmd_DebugFlagsList));
 	DCmd_Register("debugflag_enable",	WRAP_METHOD(Debugger, Cmd_DebugFlagEnable));
 	DCmd_Register("debugflag_disable",	WRAP_METHOD(Debugger, Cmd_DebugFlagDisable));
+
+	DCmd_Register("bench",			WRAP_METHOD(Debugger, Cmd_Benchmark));
 }
 
 Debugger::~Debugger() {
@@ -522,6 +526,11 @@ bool Debugger::Cmd_DebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::Cmd_Benchmark(int argc, const char **argv) {
+	Base::runBenchmark(this, argc, argv);
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
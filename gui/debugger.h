@@ -196,6 +196,7 @@ protected:
 	bool Cmd_DebugFlagsList(int argc, const char **argv);
 	bool Cmd_DebugFlagEnable(int argc, const char **argv);
 	bool Cmd_DebugFlagDisable(int argc, const char **argv);
+	bool Cmd_Benchmark(int argc, const char **argv);
 
 #ifndef USE_TEXT_CONSOLE
 private:
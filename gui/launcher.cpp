@@ -24,6 +24,7 @@
 
 #include "base/version.h"
 
+#include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/events.h"
 #include "common/fs.h"
@@ -660,11 +661,52 @@ void LauncherDialog::close() {
 	Dialog::close();
 }
 
+// Returns the description under which a target is listed
+static Common::String getTargetDescription(const Common::String &target, const ConfigManager::Domain &domain) {
+	Common::String gameid(domain.getVal("gameid"));
+	Common::String description(domain.getVal("description"));
+
+	if (gameid.empty())
+		gameid = target;
+	if (description.empty()) {
+		GameDescriptor g = EngineMan.findGame(gameid);
+		if (g.contains("description"))
+			description = g.description();
+	}
+
+	if (description.empty()) {
+		char tmp[200];
+
+		snprintf(tmp, 200, "Unknown (target %s, gameid %s)", target.c_str(), gameid.c_str());
+		description = tmp;
+	}
+
+	return description;
+}
+
+// The launcher list is sorted by description, targets with the same
+// description are sorted by name
+static bool listingLess(const Common::String &description1, const Common::String &target1,
+                        const Common::String &description2, const Common::String &target2) {
+	const int cmp = scumm_stricmp(description1.c_str(), description2.c_str());
+	return cmp < 0 || (cmp == 0 && target1 < target2);
+}
+
+struct ListingEntry {
+	Common::String description;
+	Common::String target;
+};
+
+struct ListingEntryLess {
+	bool operator()(const ListingEntry &x, const ListingEntry &y) const {
+		return listingLess(x.description, x.target, y.description, y.target);
+	}
+};
+
 void LauncherDialog::updateListing() {
-	StringArray l;
+	Common::Array<ListingEntry> entries;
 
 	// Retrieve a list of all games defined in the config file
-	_domains.clear();
 	const ConfigManager::DomainMap &domains = ConfMan.getGameDomains();
 	ConfigManager::DomainMap::const_iterator iter;
 	for (iter = domains.begin(); iter != domains.end(); ++iter) {
@@ -676,33 +718,21 @@ void LauncherDialog::updateListing() {
 		}
 #endif
 
-		String gameid(iter->_value.getVal("gameid"));
-		String description(iter->_value.getVal("description"));
-
-		if (gameid.empty())
-			gameid = iter->_key;
-		if (description.empty()) {
-			GameDescriptor g = EngineMan.findGame(gameid);
-			if (g.contains("description"))
-				description = g.description();
-		}
-
-		if (description.empty()) {
-			char tmp[200];
-
-			snprintf(tmp, 200, "Unknown (target %s, gameid %s)", iter->_key.c_str(), gameid.c_str());
-			description = tmp;
-		}
+		ListingEntry entry;
+		entry.description = getTargetDescription(iter->_key, iter->_value);
+		entry.target = iter->_key;
+		entries.push_back(entry);
+	}
 
-		if (!gameid.empty() && !description.empty()) {
-			// Insert the game into the launcher list
-			int pos = 0, size = l.size();
+	Common::sort(entries.begin(), entries.end(), ListingEntryLess());
 
-			while (pos < size && (scumm_stricmp(description.c_str(), l[pos].c_str()) > 0))
-				pos++;
-			l.insert_at(pos, description);
-			_domains.insert_at(pos, iter->_key);
-		}
+	StringArray l;
+	l.reserve(entries.size());
+	_domains.clear();
+	_domains.reserve(entries.size());
+	for (Common::Array<ListingEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+		l.push_back(i->description);
+		_domains.push_back(i->target);
 	}
 
 	const int oldSel = _list->getSelected();
@@ -719,6 +749,33 @@ void LauncherDialog::updateListing() {
 	_list->setFilter(_searchWidget->getEditString());
 }
 
+void LauncherDialog::addToListing(const String &target) {
+	const ConfigManager::Domain *domain = ConfMan.getDomain(target);
+	assert(domain);
+	const String description = getTargetDescription(target, *domain);
+
+	// Find the position of the new entry in the sorted list
+	const StringArray &list = _list->getList();
+	int low = 0, high = list.size();
+	while (low < high) {
+		const int mid = (low + high) / 2;
+		if (listingLess(list[mid], _domains[mid], description, target))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	_domains.insert_at(low, target);
+	_list->insert(low, description);
+	updateButtons();
+}
+
+void LauncherDialog::removeFromListing(int item) {
+	_domains.remove_at(item);
+	_list->remove(item);
+	updateButtons();
+}
+
 void LauncherDialog::addGame() {
 	int modifiers = g_system->getEventManager()->getModifierState();
 	
@@ -822,7 +879,7 @@ void LauncherDialog::addGame() {
 					ConfMan.flushToDisk();
 
 					// Update the ListWidget, select the new item, and force a redraw
-					updateListing();
+					addToListing(editDialog.getDomain());
 					selectTarget(editDialog.getDomain());
 					draw();
 				} else {
@@ -888,7 +945,7 @@ void LauncherDialog::removeGame(int item) {
 		ConfMan.flushToDisk();
 
 		// Update the ListWidget and force a redraw
-		updateListing();
+		removeFromListing(item);
 		draw();
 	}
 }
@@ -912,7 +969,8 @@ void LauncherDialog::editGame(int item) {
 		ConfMan.flushToDisk();
 
 		// Update the ListWidget, reselect the edited game and force a redraw
-		updateListing();
+		removeFromListing(item);
+		addToListing(editDialog.getDomain());
 		selectTarget(editDialog.getDomain());
 		draw();
 	}
@@ -81,6 +81,17 @@ protected:
 	 */
 	void updateListing();
 
+	/**
+	 * Add the given target to the list widget at its sorted position,
+	 * keeping the filter and the selection.
+	 */
+	void addToListing(const String &target);
+
+	/**
+	 * Remove the given item from the list widget.
+	 */
+	void removeFromListing(int item);
+
 	void updateButtons();
 
 	void open();
@@ -26,6 +26,7 @@
 #include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/debug.h"
+#include "common/md5cache.h"
 #include "common/system.h"
 #include "common/translation.h"
 
@@ -237,6 +238,9 @@ void MassAddDialog::handleTickle() {
 	char buf[256];
 
 	if (_scanStack.empty()) {
+		// Keep the checksums computed during the scan for the next one
+		MD5Man.flush();
+
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
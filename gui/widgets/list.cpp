@@ -35,6 +35,17 @@
 
 namespace GUI {
 
+// Checks whether a lowercase string contains all words of a filter
+static bool matchesFilter(const Common::String &str, const Common::String &filter) {
+	Common::StringTokenizer tok(filter);
+	while (!tok.empty()) {
+		if (!str.contains(tok.nextToken()))
+			return false;
+	}
+
+	return true;
+}
+
 ListWidget::ListWidget(Dialog *boss, const String &name, const char *tooltip, uint32 cmd)
 	: EditableWidget(boss, name, tooltip), _cmd(cmd) {
 
@@ -163,6 +174,10 @@ void ListWidget::setList(const StringArray &list, const ColorList *colors) {
 	_listIndex.clear();
 	_listColors.clear();
 
+	_lowercaseList = list;
+	for (StringArray::iterator i = _lowercaseList.begin(); i != _lowercaseList.end(); ++i)
+		i->toLowercase();
+
 	if (colors) {
 		_listColors = *colors;
 		assert(_listColors.size() == _dataList.size());
@@ -180,22 +195,96 @@ void ListWidget::setList(const StringArray &list, const ColorList *colors) {
 }
 
 void ListWidget::append(const String &s, ThemeEngine::FontColor color) {
+	insert(_dataList.size(), s, color);
+}
+
+void ListWidget::insert(int item, const String &s, ThemeEngine::FontColor color) {
+	assert(item >= 0 && item <= (int)_dataList.size());
+
+	if (_editMode)
+		abortEditMode();
+
 	if (_dataList.size() == _listColors.size()) {
-		// If the color list has the size of the data list, we append the color.
-		_listColors.push_back(color);
+		// If the color list has the size of the data list, we insert the color.
+		_listColors.insert_at(item, color);
 	} else if (!_listColors.size() && color != ThemeEngine::kFontColorNormal) {
 		// If it's the first entry to use a non default color, we will fill
 		// up all other entries of the color list with the default color and
 		// add the requested color for the new entry.
 		for (uint i = 0; i < _dataList.size(); ++i)
 			_listColors.push_back(ThemeEngine::kFontColorNormal);
-		_listColors.push_back(color);
+		_listColors.insert_at(item, color);
 	}
 
-	_dataList.push_back(s);
-	_list.push_back(s);
+	String lowercase(s);
+	lowercase.toLowercase();
+
+	_dataList.insert_at(item, s);
+	_lowercaseList.insert_at(item, lowercase);
+
+	int pos = item;
+	if (!_filter.empty()) {
+		// Shift the following entries, and find where the new one goes
+		pos = 0;
+		for (uint i = 0; i < _listIndex.size(); ++i) {
+			if (_listIndex[i] >= item)
+				_listIndex[i]++;
+			else
+				pos = i + 1;
+		}
+
+		if (matchesFilter(lowercase, _filter))
+			_listIndex.insert_at(pos, item);
+		else
+			pos = -1;
+	}
 
-	setFilter(_filter, false);
+	if (pos != -1) {
+		_list.insert_at(pos, s);
+		if (_selectedItem >= pos)
+			_selectedItem++;
+	}
+
+	scrollBarRecalc();
+}
+
+void ListWidget::remove(int item) {
+	assert(item >= 0 && item < (int)_dataList.size());
+
+	if (_editMode)
+		abortEditMode();
+
+	if (!_listColors.empty())
+		_listColors.remove_at(item);
+	_dataList.remove_at(item);
+	_lowercaseList.remove_at(item);
+
+	int pos = item;
+	if (!_filter.empty()) {
+		pos = -1;
+		for (uint i = 0; i < _listIndex.size(); ++i) {
+			if (_listIndex[i] == item)
+				pos = i;
+			else if (_listIndex[i] > item)
+				_listIndex[i]--;
+		}
+
+		if (pos != -1)
+			_listIndex.remove_at(pos);
+	}
+
+	if (pos != -1) {
+		_list.remove_at(pos);
+
+		const bool selectionRemoved = (_selectedItem == pos);
+		if (_selectedItem > pos || _selectedItem >= (int)_list.size())
+			_selectedItem--;
+		if (selectionRemoved)
+			sendCommand(kListSelectionChangedCmd, _selectedItem);
+	}
+
+	if (_currentPos + _entriesPerPage > (int)_list.size())
+		_currentPos = MAX((int)_list.size() - _entriesPerPage, 0);
 
 	scrollBarRecalc();
 }
@@ -674,6 +763,10 @@ void ListWidget::setFilter(const String &filter, bool redraw) {
 	if (_filter == filt) // Filter was not changed
 		return;
 
+	// When characters were added to the filter, only the entries which
+	// matched the old one can match the new one, so only those are checked.
+	const bool narrowed = !_filter.empty() && filt.hasPrefix(_filter);
+
 	_filter = filt;
 
 	if (_filter.empty()) {
@@ -683,28 +776,19 @@ void ListWidget::setFilter(const String &filter, bool redraw) {
 	} else {
 		// Restrict the list to everything which contains all words in _filter
 		// as substrings, ignoring case.
+		Common::Array<int> candidates;
+		if (narrowed)
+			candidates = _listIndex;
 
-		Common::StringTokenizer tok(_filter);
-		String tmp;
-		int n = 0;
+		const int count = narrowed ? candidates.size() : _dataList.size();
 
 		_list.clear();
 		_listIndex.clear();
 
-		for (StringArray::iterator i = _dataList.begin(); i != _dataList.end(); ++i, ++n) {
-			tmp = *i;
-			tmp.toLowercase();
-			bool matches = true;
-			tok.reset();
-			while (!tok.empty()) {
-				if (!tmp.contains(tok.nextToken())) {
-					matches = false;
-					break;
-				}
-			}
-
-			if (matches) {
-				_list.push_back(*i);
+		for (int i = 0; i < count; ++i) {
+			const int n = narrowed ? candidates[i] : i;
+			if (matchesFilter(_lowercaseList[n], _filter)) {
+				_list.push_back(_dataList[n]);
 				_listIndex.push_back(n);
 			}
 		}
@@ -57,6 +57,7 @@ public:
 protected:
 	StringArray		_list;
 	StringArray		_dataList;
+	StringArray		_lowercaseList;	///< Lowercase copy of _dataList, used for filtering
 	ColorList		_listColors;
 	Common::Array<int>		_listIndex;
 	bool			_editable;
@@ -98,6 +99,19 @@ public:
 
 	void append(const String &s, ThemeEngine::FontColor color = ThemeEngine::kFontColorNormal);
 
+	/**
+	 * Insert an entry before the given item of the unfiltered list. The entry
+	 * is only shown if it matches the current filter. Unlike setList(), this
+	 * keeps the filter, the selection and the scroll position.
+	 */
+	void insert(int item, const String &s, ThemeEngine::FontColor color = ThemeEngine::kFontColorNormal);
+
+	/**
+	 * Remove the given item of the unfiltered list. If it was selected, the
+	 * entry taking its place is selected instead.
+	 */
+	void remove(int item);
+
 	void setSelected(int item);
 	int getSelected() const						{ return (_filter.empty() || _selectedItem == -1) ? _selectedItem : _listIndex[_selectedItem]; }
 
@@ -0,0 +1,114 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/dbopl.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+// Renders pseudo random register sequences through the DOSBox OPL emulator
+// and compares a hash of the output against the one produced by the plain
+// per-sample renderer, so optimizations of the block code stay bit-exact.
+class DBOPLTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kRate = 44100,
+		kSteps = 400
+	};
+
+	uint32 _seed;
+
+	uint32 random() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 8) & 0xFFFF;
+	}
+
+	static void hashOutput(uint32 &hash, const int32 *data, uint32 count) {
+		// FNV-1a over the 32 bit samples
+		for (uint32 i = 0; i < count; ++i) {
+			uint32 v = (uint32)data[i];
+			for (int b = 0; b < 4; ++b) {
+				hash ^= (v >> (b * 8)) & 0xFF;
+				hash *= 16777619;
+			}
+		}
+	}
+
+	uint32 randomRegister(bool opl3) {
+		static const uint16 bases[] = { 0x20, 0x40, 0x60, 0x80, 0xE0, 0xA0, 0xB0, 0xC0 };
+
+		const uint32 r = random();
+		if (r % 23 == 0)
+			return 0xBD;
+
+		const uint16 base = bases[r % ARRAYSIZE(bases)];
+		uint16 reg = base + ((base < 0xA0 || base >= 0xE0) ? (random() % 0x16) : (random() % 9));
+		if (opl3 && (random() & 1))
+			reg |= 0x100;
+		return reg;
+	}
+
+	uint32 render(bool opl3, bool percussion, uint32 seed) {
+		using namespace OPL::DOSBox::DBOPL;
+
+		_seed = seed;
+		InitTables();
+		Chip *chip = new Chip();
+		chip->Setup(kRate);
+
+		// Enable wave form selection
+		chip->WriteReg(0x01, 0x20);
+		if (opl3) {
+			chip->WriteReg(0x105, 1);
+			chip->WriteReg(0x104, random() & 0x3F);
+		}
+
+		int32 buffer[1024 * 2];
+		uint32 hash = 2166136261u;
+
+		for (int step = 0; step < kSteps; ++step) {
+			const int writes = random() % 8;
+			for (int i = 0; i < writes; ++i) {
+				const uint32 reg = randomRegister(opl3);
+				uint8 val = random() & 0xFF;
+
+				if (reg == 0xBD && !percussion)
+					val &= ~0x20;
+				// Keep attack rates reasonably high, so notes actually sound
+				if ((reg & 0xF0) == 0x60 && (val & 0xF0) < 0x40)
+					val |= 0x80;
+
+				chip->WriteReg(reg, val);
+			}
+
+			const uint32 samples = 1 + random() % 1024;
+			if (chip->opl3Active) {
+				chip->GenerateBlock3(samples, buffer);
+				hashOutput(hash, buffer, samples * 2);
+			} else {
+				chip->GenerateBlock2(samples, buffer);
+				hashOutput(hash, buffer, samples);
+			}
+		}
+
+		delete chip;
+		return hash;
+	}
+
+public:
+	void test_opl2_melodic() {
+		TS_ASSERT_EQUALS(render(false, false, 1), 0x21a31675u);
+		TS_ASSERT_EQUALS(render(false, false, 2), 0xf11e3678u);
+	}
+
+	void test_opl2_percussion() {
+		TS_ASSERT_EQUALS(render(false, true, 3), 0x6e77154bu);
+		TS_ASSERT_EQUALS(render(false, true, 4), 0xb34e30d5u);
+	}
+
+	void test_opl3() {
+		TS_ASSERT_EQUALS(render(true, false, 5), 0x773b3958u);
+		TS_ASSERT_EQUALS(render(true, true, 6), 0x7d215cecu);
+	}
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/fmopl.h"
+
+#include "common/memstream.h"
+
+class OPLCaptureTestSuite : public CxxTest::TestSuite
+{
+private:
+	// Records everything done to it as a string
+	class LogOPL : public OPL::OPL {
+	public:
+		Common::String log;
+
+		bool init(int rate) { return true; }
+		void reset() { log += "R "; }
+		void write(int a, int v) { log += Common::String::format("W%x=%x ", a, v); }
+		byte read(int a) { return 0; }
+		void writeReg(int r, int v) { log += Common::String::format("%x=%x ", r, v); }
+		void readBuffer(int16 *buffer, int length) {
+			log += Common::String::format("[%d] ", length);
+			memset(buffer, 0, length * sizeof(int16));
+		}
+		bool isStereo() const { return false; }
+	};
+
+	static void writeEvent(byte *&dst, uint32 sample, byte type, uint16 reg, byte value) {
+		WRITE_LE_UINT32(dst, sample);
+		dst[4] = type;
+		dst[5] = value;
+		WRITE_LE_UINT16(dst + 6, reg);
+		dst += 8;
+	}
+
+public:
+	void test_replay() {
+		byte data[10 + 5 * 8];
+		byte *dst = data;
+		WRITE_BE_UINT32(dst, MKTAG('O', 'P', 'L', 'C'));
+		dst[4] = 1;
+		dst[5] = OPL::Config::kOpl2;
+		WRITE_LE_UINT32(dst + 6, 22050);
+		dst += 10;
+
+		writeEvent(dst, 0, OPL::Capture::kEventReset, 0, 0);
+		writeEvent(dst, 0, OPL::Capture::kEventWriteReg, 0xB0, 0x20);
+		writeEvent(dst, 100, OPL::Capture::kEventWrite, 0x388, 0xBD);
+		writeEvent(dst, 150, OPL::Capture::kEventWriteReg, 0xB0, 0x00);
+		writeEvent(dst, 200, OPL::Capture::kEventEnd, 0, 0);
+
+		Common::MemoryReadStream stream(data, sizeof(data));
+		OPL::Capture capture;
+		TS_ASSERT(capture.load(stream));
+		TS_ASSERT_EQUALS(capture.getType(), OPL::Config::kOpl2);
+		TS_ASSERT_EQUALS(capture.getRate(), 22050);
+		TS_ASSERT_EQUALS(capture.getLength(), 200u);
+
+		LogOPL opl;
+		int16 buffer[200];
+		capture.replay(&opl, buffer);
+		TS_ASSERT_EQUALS(opl.log, "R b0=20 [100] W388=bd [50] b0=0 [50] ");
+	}
+
+	void test_truncated() {
+		byte data[10 + 8 + 3];
+		byte *dst = data;
+		WRITE_BE_UINT32(dst, MKTAG('O', 'P', 'L', 'C'));
+		dst[4] = 1;
+		dst[5] = OPL::Config::kOpl3;
+		WRITE_LE_UINT32(dst + 6, 44100);
+		dst += 10;
+		writeEvent(dst, 42, OPL::Capture::kEventWriteReg, 0x105, 0x01);
+
+		// The partial event is dropped, and the end is the last write
+		Common::MemoryReadStream stream(data, sizeof(data));
+		OPL::Capture capture;
+		TS_ASSERT(capture.load(stream));
+		TS_ASSERT_EQUALS(capture.getLength(), 42u);
+
+		data[5] = OPL::Config::kOpl3 + 1;
+		Common::MemoryReadStream badType(data, sizeof(data));
+		TS_ASSERT(!capture.load(badType));
+
+		data[0] = 'X';
+		Common::MemoryReadStream bad(data, sizeof(data));
+		TS_ASSERT(!capture.load(bad));
+	}
+};
@@ -0,0 +1,263 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+
+// Builds a ZIP archive in memory, and opens it from an archive of its own,
+// so its files can be streamed. They are large enough to be streamed, rather
+// than read into memory at once.
+class TestZip {
+public:
+	enum {
+		kFileSize = 1024 * 1024 + 1000
+	};
+
+	static byte contents(uint32 pos) {
+		return (byte)(pos * 7 + (pos >> 11));
+	}
+
+	TestZip(bool brokenChecksums) : _data(0), _archive(0) {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		const uint32 crc = checksum() ^ (brokenChecksums ? 1 : 0);
+
+		const uint32 storedOffset = zip.pos();
+		writeLocalHeader(zip, "stored.bin", 0, crc, kFileSize);
+		for (uint32 i = 0; i < kFileSize; ++i)
+			zip.writeByte(contents(i));
+
+		// Deflate data made of stored blocks only, which is simple to build
+		// but has to be inflated all the same
+		const uint32 deflatedOffset = zip.pos();
+		const uint32 deflatedSize = kFileSize + 5 * ((kFileSize + 0xFFFE) / 0xFFFF);
+		writeLocalHeader(zip, "deflated.bin", 8, crc, deflatedSize);
+		for (uint32 i = 0; i < kFileSize; i += 0xFFFF) {
+			const uint16 length = MIN<uint32>(kFileSize - i, 0xFFFF);
+			zip.writeByte(i + length == kFileSize ? 1 : 0);
+			zip.writeUint16LE(length);
+			zip.writeUint16LE((uint16)~length);
+			for (uint32 j = i; j < i + length; ++j)
+				zip.writeByte(contents(j));
+		}
+
+		const uint32 directoryOffset = zip.pos();
+		writeCentralHeader(zip, "stored.bin", 0, crc, kFileSize, storedOffset);
+		writeCentralHeader(zip, "deflated.bin", 8, crc, deflatedSize, deflatedOffset);
+		const uint32 directorySize = zip.pos() - directoryOffset;
+
+		zip.writeUint32LE(0x06054B50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(2);
+		zip.writeUint16LE(2);
+		zip.writeUint32LE(directorySize);
+		zip.writeUint32LE(directoryOffset);
+		zip.writeUint16LE(0);
+
+		_data = new DataArchive(zip.getData(), zip.size());
+		_archive = Common::makeZipArchive("test.zip", *_data);
+	}
+
+	~TestZip() {
+		delete _archive;
+		delete _data;
+	}
+
+	Common::SeekableReadStream *open(const char *name) {
+		return _archive ? _archive->createReadStreamForMember(name) : 0;
+	}
+
+private:
+	// Serves the archive data, from where the ZIP archive opens it
+	class DataArchive : public Common::Archive {
+	public:
+		DataArchive(byte *data, uint32 size) : _data(data), _size(size) {}
+		~DataArchive() { free(_data); }
+
+		bool hasFile(const Common::String &name) { return name == "test.zip"; }
+
+		int listMembers(Common::ArchiveMemberList &list) {
+			list.push_back(getMember("test.zip"));
+			return 1;
+		}
+
+		Common::ArchiveMemberPtr getMember(const Common::String &name) {
+			return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+		}
+
+		Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			if (name != "test.zip")
+				return 0;
+			return new Common::MemoryReadStream(_data, _size);
+		}
+
+	private:
+		byte *_data;
+		uint32 _size;
+	};
+
+	static uint32 checksum() {
+		uint32 crc = 0xFFFFFFFF;
+		for (uint32 i = 0; i < kFileSize; ++i) {
+			crc ^= contents(i);
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+		return ~crc;
+	}
+
+	static void writeFileInfo(Common::WriteStream &zip, uint16 method, uint32 crc, uint32 compressedSize) {
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(method);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint32LE(crc);
+		zip.writeUint32LE(compressedSize);
+		zip.writeUint32LE(kFileSize);
+	}
+
+	static void writeLocalHeader(Common::WriteStream &zip, const char *name, uint16 method, uint32 crc, uint32 compressedSize) {
+		zip.writeUint32LE(0x04034B50);
+		writeFileInfo(zip, method, crc, compressedSize);
+		zip.writeUint16LE(strlen(name));
+		zip.writeUint16LE(0);
+		zip.write(name, strlen(name));
+	}
+
+	static void writeCentralHeader(Common::WriteStream &zip, const char *name, uint16 method, uint32 crc, uint32 compressedSize, uint32 offset) {
+		zip.writeUint32LE(0x02014B50);
+		zip.writeUint16LE(20);
+		writeFileInfo(zip, method, crc, compressedSize);
+		zip.writeUint16LE(strlen(name));
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(offset);
+		zip.write(name, strlen(name));
+	}
+
+	DataArchive *_data;
+	Common::Archive *_archive;
+};
+
+class ZipTestSuite : public CxxTest::TestSuite {
+	// Reads the given amount of data, and checks that it is what the file
+	// contains at the current position
+	static bool readAndCompare(Common::SeekableReadStream &stream, uint32 length) {
+		byte buffer[4096];
+		uint32 pos = stream.pos();
+		while (length) {
+			const uint32 chunk = MIN<uint32>(length, sizeof(buffer));
+			if (stream.read(buffer, chunk) != chunk)
+				return false;
+			for (uint32 i = 0; i < chunk; ++i) {
+				if (buffer[i] != TestZip::contents(pos + i))
+					return false;
+			}
+			pos += chunk;
+			length -= chunk;
+		}
+		return true;
+	}
+
+	void checkSequentialRead(const char *name) {
+		TestZip zip(false);
+		Common::SeekableReadStream *stream = zip.open(name);
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		TS_ASSERT_EQUALS(stream->size(), (int32)TestZip::kFileSize);
+		TS_ASSERT(readAndCompare(*stream, TestZip::kFileSize));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT(!stream->err());
+
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+	}
+
+	void checkSeeking(const char *name) {
+		TestZip zip(false);
+		Common::SeekableReadStream *stream = zip.open(name);
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		// Back to the start after a partial read
+		TS_ASSERT(readAndCompare(*stream, 5000));
+		TS_ASSERT(stream->seek(0));
+		TS_ASSERT_EQUALS(stream->pos(), 0);
+		TS_ASSERT(readAndCompare(*stream, 70000));
+
+		// Back to the middle
+		TS_ASSERT(stream->seek(TestZip::kFileSize * 3 / 4));
+		TS_ASSERT(stream->seek(TestZip::kFileSize / 2));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)TestZip::kFileSize / 2);
+		TS_ASSERT(readAndCompare(*stream, TestZip::kFileSize / 2));
+
+		// Relative to the end
+		TS_ASSERT(stream->seek(-16, SEEK_END));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)TestZip::kFileSize - 16);
+		TS_ASSERT(readAndCompare(*stream, 16));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT(!stream->err());
+
+		TS_ASSERT(stream->seek(0, SEEK_END));
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+	}
+
+	void checkBrokenChecksum(const char *name) {
+		TestZip zip(true);
+		Common::SeekableReadStream *stream = zip.open(name);
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		// The data is still read, the error only shows at the end
+		TS_ASSERT(readAndCompare(*stream, TestZip::kFileSize - 1));
+		TS_ASSERT(!stream->err());
+		TS_ASSERT(readAndCompare(*stream, 1));
+		TS_ASSERT(stream->err());
+
+		delete stream;
+	}
+
+	public:
+	void test_stored_sequential_read() {
+		checkSequentialRead("stored.bin");
+	}
+
+	void test_stored_seek() {
+		checkSeeking("stored.bin");
+	}
+
+#ifdef USE_ZLIB
+	// Checksums are only verified with zlib, and deflated files need it
+	// to be read at all
+
+	void test_stored_broken_checksum() {
+		checkBrokenChecksum("stored.bin");
+	}
+
+	void test_deflated_sequential_read() {
+		checkSequentialRead("deflated.bin");
+	}
+
+	void test_deflated_seek() {
+		checkSeeking("deflated.bin");
+	}
+
+	void test_deflated_broken_checksum() {
+		checkBrokenChecksum("deflated.bin");
+	}
+#endif
+};
@@ -0,0 +1,97 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/conversion.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "common/endian.h"
+
+// Compares the converter, which may use SIMD, with a plain conversion
+// of every pixel through YUV2RGB and PixelFormat::RGBToColor.
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 70,
+		kHeight = 22
+	};
+
+	byte _y[kWidth * kHeight];
+	byte _u[kWidth * kHeight];
+	byte _v[kWidth * kHeight];
+
+	void fillPlanes() {
+		uint32 seed = 1;
+		for (int i = 0; i < kWidth * kHeight; i++) {
+			seed = seed * 1103515245 + 12345;
+			_y[i] = seed >> 8;
+			_u[i] = seed >> 16;
+			_v[i] = seed >> 24;
+		}
+	}
+
+	bool compare(const Graphics::PixelFormat &format, Graphics::YUVToRGB::ColorSpace colorSpace, int chromaShift) {
+		Graphics::YUVToRGB converter(format, colorSpace);
+		const int bpp = format.bytesPerPixel;
+		const int uvPitch = (kWidth + (1 << chromaShift) - 1) >> chromaShift;
+
+		byte converted[kWidth * kHeight * 4];
+		if (chromaShift == 0)
+			converter.convert444(converted, kWidth * bpp, _y, _u, _v, kWidth, kHeight, kWidth, uvPitch);
+		else if (chromaShift == 1)
+			converter.convert420(converted, kWidth * bpp, _y, _u, _v, kWidth, kHeight, kWidth, uvPitch);
+		else
+			converter.convert410(converted, kWidth * bpp, _y, _u, _v, kWidth, kHeight, kWidth, uvPitch);
+
+		for (int y = 0; y < kHeight; y++) {
+			for (int x = 0; x < kWidth; x++) {
+				const byte cY = _y[y * kWidth + x];
+				const byte cU = _u[(y >> chromaShift) * uvPitch + (x >> chromaShift)];
+				const byte cV = _v[(y >> chromaShift) * uvPitch + (x >> chromaShift)];
+
+				byte r, g, b;
+				if (colorSpace == Graphics::YUVToRGB::kColorSpaceCinepak) {
+					r = CLIP<int>(cY + 2 * (cV - 128), 0, 255);
+					g = CLIP<int>(cY - (cU - 128) / 2 - (cV - 128), 0, 255);
+					b = CLIP<int>(cY + 2 * (cU - 128), 0, 255);
+				} else {
+					Graphics::YUV2RGB(cY, cU, cV, r, g, b);
+				}
+
+				const byte *pixel = converted + (y * kWidth + x) * bpp;
+				const uint32 color = (bpp == 2) ? READ_UINT16(pixel) : READ_UINT32(pixel);
+				if (color != format.RGBToColor(r, g, b))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+public:
+	void test_rgb565() {
+		fillPlanes();
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		for (int shift = 0; shift <= 2; shift++)
+			TS_ASSERT(compare(format, Graphics::YUVToRGB::kColorSpaceDefault, shift));
+	}
+
+	void test_argb1555() {
+		fillPlanes();
+		const Graphics::PixelFormat format(2, 5, 5, 5, 1, 10, 5, 0, 15);
+		for (int shift = 0; shift <= 2; shift++)
+			TS_ASSERT(compare(format, Graphics::YUVToRGB::kColorSpaceDefault, shift));
+	}
+
+	void test_argb8888() {
+		fillPlanes();
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		for (int shift = 0; shift <= 2; shift++)
+			TS_ASSERT(compare(format, Graphics::YUVToRGB::kColorSpaceDefault, shift));
+	}
+
+	void test_cinepak() {
+		fillPlanes();
+		TS_ASSERT(compare(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), Graphics::YUVToRGB::kColorSpaceCinepak, 0));
+		TS_ASSERT(compare(Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0), Graphics::YUVToRGB::kColorSpaceCinepak, 0));
+	}
+};
@@ -32,25 +32,18 @@
 #include "common/util.h"
 
 #include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
 
 // Code here partially based off of ffmpeg ;)
 
 namespace Video {
 
-// Convert a color from YUV to RGB colorspace, Cinepak style.
-inline static void CPYUV2RGB(byte y, byte u, byte v, byte &r, byte &g, byte &b) {
-	r = CLIP<int>(y + 2 * (v - 128), 0, 255);
-	g = CLIP<int>(y - (u - 128) / 2 - (v - 128), 0, 255);
-	b = CLIP<int>(y + 2 * (u - 128), 0, 255);
-}
-
-#define PUT_PIXEL(offset, lum, u, v) \
+#define PUT_PIXEL(offset, lum, rgb) \
 	if (_pixelFormat.bytesPerPixel != 1) { \
-		CPYUV2RGB(lum, u, v, r, g, b); \
 		if (_pixelFormat.bytesPerPixel == 2) \
-			*((uint16 *)_curFrame.surface->pixels + offset) = _pixelFormat.RGBToColor(r, g, b); \
+			*((uint16 *)_curFrame.surface->pixels + offset) = rgb; \
 		else \
-			*((uint32 *)_curFrame.surface->pixels + offset) = _pixelFormat.RGBToColor(r, g, b); \
+			*((uint32 *)_curFrame.surface->pixels + offset) = rgb; \
 	} else \
 		*((byte *)_curFrame.surface->pixels + offset) = lum
 
@@ -59,10 +52,14 @@ CinepakDecoder::CinepakDecoder(int bitsPerPixel) : Codec() {
 	_curFrame.strips = NULL;
 	_y = 0;
 
-	if (bitsPerPixel == 8)
+	_yuvConverter = 0;
+
+	if (bitsPerPixel == 8) {
 		_pixelFormat = Graphics::PixelFormat::createFormatCLUT8();
-	else
+	} else {
 		_pixelFormat = g_system->getScreenFormat();
+		_yuvConverter = new Graphics::YUVToRGB(_pixelFormat, Graphics::YUVToRGB::kColorSpaceCinepak);
+	}
 }
 
 CinepakDecoder::~CinepakDecoder() {
@@ -72,6 +69,7 @@ CinepakDecoder::~CinepakDecoder() {
 	}
 
 	delete[] _curFrame.strips;
+	delete _yuvConverter;
 }
 
 const Graphics::Surface *CinepakDecoder::decodeImage(Common::SeekableReadStream *stream) {
@@ -199,6 +197,17 @@ void CinepakDecoder::loadCodebook(Common::SeekableReadStream *stream, uint16 str
 				codebook[i].u  = 128;
 				codebook[i].v  = 128;
 			}
+
+			// Convert the colors right away, the vectors only copy them
+			if (_yuvConverter) {
+				const byte u[4] = { codebook[i].u, codebook[i].u, codebook[i].u, codebook[i].u };
+				const byte v[4] = { codebook[i].v, codebook[i].v, codebook[i].v, codebook[i].v };
+				byte pixels[4 * 4];
+				_yuvConverter->convertLine(pixels, codebook[i].y, u, v, 4);
+
+				for (byte j = 0; j < 4; j++)
+					codebook[i].rgb[j] = (_pixelFormat.bytesPerPixel == 2) ? READ_UINT16(pixels + j * 2) : READ_UINT32(pixels + j * 4);
+			}
 		}
 	}
 }
@@ -207,7 +216,6 @@ void CinepakDecoder::decodeVectors(Common::SeekableReadStream *stream, uint16 st
 	uint32 flag = 0, mask = 0;
 	uint32 iy[4];
 	int32 startPos = stream->pos();
-	byte r = 0, g = 0, b = 0;
 
 	for (uint16 y = _curFrame.strips[strip].rect.top; y < _curFrame.strips[strip].rect.bottom; y += 4) {
 		iy[0] = _curFrame.strips[strip].rect.left + y * _curFrame.width;
@@ -238,54 +246,54 @@ void CinepakDecoder::decodeVectors(Common::SeekableReadStream *stream, uint16 st
 						return;
 
 					// Get the codebook
-					CinepakCodebook codebook = _curFrame.strips[strip].v1_codebook[stream->readByte()];
-
-					PUT_PIXEL(iy[0] + 0, codebook.y[0], codebook.u, codebook.v);
-					PUT_PIXEL(iy[0] + 1, codebook.y[0], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 0, codebook.y[0], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 1, codebook.y[0], codebook.u, codebook.v);
-
-					PUT_PIXEL(iy[0] + 2, codebook.y[1], codebook.u, codebook.v);
-					PUT_PIXEL(iy[0] + 3, codebook.y[1], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 2, codebook.y[1], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 3, codebook.y[1], codebook.u, codebook.v);
-
-					PUT_PIXEL(iy[2] + 0, codebook.y[2], codebook.u, codebook.v);
-					PUT_PIXEL(iy[2] + 1, codebook.y[2], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 0, codebook.y[2], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 1, codebook.y[2], codebook.u, codebook.v);
-
-					PUT_PIXEL(iy[2] + 2, codebook.y[3], codebook.u, codebook.v);
-					PUT_PIXEL(iy[2] + 3, codebook.y[3], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 2, codebook.y[3], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 3, codebook.y[3], codebook.u, codebook.v);
+					const CinepakCodebook &codebook = _curFrame.strips[strip].v1_codebook[stream->readByte()];
+
+					PUT_PIXEL(iy[0] + 0, codebook.y[0], codebook.rgb[0]);
+					PUT_PIXEL(iy[0] + 1, codebook.y[0], codebook.rgb[0]);
+					PUT_PIXEL(iy[1] + 0, codebook.y[0], codebook.rgb[0]);
+					PUT_PIXEL(iy[1] + 1, codebook.y[0], codebook.rgb[0]);
+
+					PUT_PIXEL(iy[0] + 2, codebook.y[1], codebook.rgb[1]);
+					PUT_PIXEL(iy[0] + 3, codebook.y[1], codebook.rgb[1]);
+					PUT_PIXEL(iy[1] + 2, codebook.y[1], codebook.rgb[1]);
+					PUT_PIXEL(iy[1] + 3, codebook.y[1], codebook.rgb[1]);
+
+					PUT_PIXEL(iy[2] + 0, codebook.y[2], codebook.rgb[2]);
+					PUT_PIXEL(iy[2] + 1, codebook.y[2], codebook.rgb[2]);
+					PUT_PIXEL(iy[3] + 0, codebook.y[2], codebook.rgb[2]);
+					PUT_PIXEL(iy[3] + 1, codebook.y[2], codebook.rgb[2]);
+
+					PUT_PIXEL(iy[2] + 2, codebook.y[3], codebook.rgb[3]);
+					PUT_PIXEL(iy[2] + 3, codebook.y[3], codebook.rgb[3]);
+					PUT_PIXEL(iy[3] + 2, codebook.y[3], codebook.rgb[3]);
+					PUT_PIXEL(iy[3] + 3, codebook.y[3], codebook.rgb[3]);
 				} else if (flag & mask) {
 					if ((stream->pos() - startPos + 4) > (int32)chunkSize)
 						return;
 
-					CinepakCodebook codebook = _curFrame.strips[strip].v4_codebook[stream->readByte()];
-					PUT_PIXEL(iy[0] + 0, codebook.y[0], codebook.u, codebook.v);
-					PUT_PIXEL(iy[0] + 1, codebook.y[1], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 0, codebook.y[2], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 1, codebook.y[3], codebook.u, codebook.v);
-
-					codebook = _curFrame.strips[strip].v4_codebook[stream->readByte()];
-					PUT_PIXEL(iy[0] + 2, codebook.y[0], codebook.u, codebook.v);
-					PUT_PIXEL(iy[0] + 3, codebook.y[1], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 2, codebook.y[2], codebook.u, codebook.v);
-					PUT_PIXEL(iy[1] + 3, codebook.y[3], codebook.u, codebook.v);
-
-					codebook = _curFrame.strips[strip].v4_codebook[stream->readByte()];
-					PUT_PIXEL(iy[2] + 0, codebook.y[0], codebook.u, codebook.v);
-					PUT_PIXEL(iy[2] + 1, codebook.y[1], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 0, codebook.y[2], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 1, codebook.y[3], codebook.u, codebook.v);
-
-					codebook = _curFrame.strips[strip].v4_codebook[stream->readByte()];
-					PUT_PIXEL(iy[2] + 2, codebook.y[0], codebook.u, codebook.v);
-					PUT_PIXEL(iy[2] + 3, codebook.y[1], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 2, codebook.y[2], codebook.u, codebook.v);
-					PUT_PIXEL(iy[3] + 3, codebook.y[3], codebook.u, codebook.v);
+					const CinepakCodebook *codebook = &_curFrame.strips[strip].v4_codebook[stream->readByte()];
+					PUT_PIXEL(iy[0] + 0, codebook->y[0], codebook->rgb[0]);
+					PUT_PIXEL(iy[0] + 1, codebook->y[1], codebook->rgb[1]);
+					PUT_PIXEL(iy[1] + 0, codebook->y[2], codebook->rgb[2]);
+					PUT_PIXEL(iy[1] + 1, codebook->y[3], codebook->rgb[3]);
+
+					codebook = &_curFrame.strips[strip].v4_codebook[stream->readByte()];
+					PUT_PIXEL(iy[0] + 2, codebook->y[0], codebook->rgb[0]);
+					PUT_PIXEL(iy[0] + 3, codebook->y[1], codebook->rgb[1]);
+					PUT_PIXEL(iy[1] + 2, codebook->y[2], codebook->rgb[2]);
+					PUT_PIXEL(iy[1] + 3, codebook->y[3], codebook->rgb[3]);
+
+					codebook = &_curFrame.strips[strip].v4_codebook[stream->readByte()];
+					PUT_PIXEL(iy[2] + 0, codebook->y[0], codebook->rgb[0]);
+					PUT_PIXEL(iy[2] + 1, codebook->y[1], codebook->rgb[1]);
+					PUT_PIXEL(iy[3] + 0, codebook->y[2], codebook->rgb[2]);
+					PUT_PIXEL(iy[3] + 1, codebook->y[3], codebook->rgb[3]);
+
+					codebook = &_curFrame.strips[strip].v4_codebook[stream->readByte()];
+					PUT_PIXEL(iy[2] + 2, codebook->y[0], codebook->rgb[0]);
+					PUT_PIXEL(iy[2] + 3, codebook->y[1], codebook->rgb[1]);
+					PUT_PIXEL(iy[3] + 2, codebook->y[2], codebook->rgb[2]);
+					PUT_PIXEL(iy[3] + 3, codebook->y[3], codebook->rgb[3]);
 				}
 			}
 
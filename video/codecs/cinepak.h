@@ -38,6 +38,7 @@ class SeekableReadStream;
 
 namespace Graphics {
 struct Surface;
+class YUVToRGB;
 }
 
 namespace Video {
@@ -45,6 +46,7 @@ namespace Video {
 struct CinepakCodebook {
 	byte y[4];
 	byte u, v;
+	uint32 rgb[4]; // y[] converted to the output pixel format
 };
 
 struct CinepakStrip {
@@ -77,6 +79,7 @@ private:
 	CinepakFrame _curFrame;
 	int32 _y;
 	Graphics::PixelFormat _pixelFormat;
+	Graphics::YUVToRGB *_yuvConverter;
 
 	void loadCodebook(Common::SeekableReadStream *stream, uint16 strip, byte codebookType, byte chunkID, uint32 chunkSize);
 	void decodeVectors(Common::SeekableReadStream *stream, uint16 strip, byte chunkID, uint32 chunkSize);
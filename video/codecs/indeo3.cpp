@@ -37,8 +37,9 @@
 #include "common/endian.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
+#include "common/util.h"
 
-#include "graphics/conversion.h"
+#include "graphics/yuv_to_rgb.h"
 
 #include "video/codecs/indeo3.h"
 
@@ -53,6 +54,12 @@ Indeo3Decoder::Indeo3Decoder(uint16 width, uint16 height) : _ModPred(0), _correc
 	_surface = new Graphics::Surface;
 	_surface->create(width, height, _pixelFormat.bytesPerPixel);
 
+	// Rounded up, as the chroma is interpolated for whole 4 pixel blocks
+	_lineU = new byte[((width + 3) & ~3) * 2];
+	_lineV = _lineU + ((width + 3) & ~3);
+
+	_yuvConverter = new Graphics::YUVToRGB(_pixelFormat);
+
 	buildModPred();
 	allocFrames();
 }
@@ -64,6 +71,8 @@ Indeo3Decoder::~Indeo3Decoder() {
 	delete[] _iv_frame[0].the_buf;
 	delete[] _ModPred;
 	delete[] _corrector_type;
+	delete[] _lineU;
+	delete _yuvConverter;
 }
 
 Graphics::PixelFormat Indeo3Decoder::getPixelFormat() const {
@@ -265,6 +274,11 @@ const Graphics::Surface *Indeo3Decoder::decodeImage(Common::SeekableReadStream *
 
 	delete[] inData;
 
+	if (fWidth > _surface->w || fHeight > _surface->h) {
+		warning("Indeo3Decoder::decodeImage: Frame larger than the surface (%dx%d)", fWidth, fHeight);
+		return _surface;
+	}
+
 	// Blit the frame onto the surface
 	const byte *srcY = _cur_frame->Ybuf;
 	const byte *srcU = _cur_frame->Ubuf;
@@ -280,58 +294,33 @@ const Graphics::Surface *Indeo3Decoder::decodeImage(Common::SeekableReadStream *
 	uint32 scaleHeight = _surface->h / fHeight;
 
 	for (uint32 y = 0; y < fHeight; y++) {
-		byte *rowDest = dest;
-
-		for (uint32 sH = 0; sH < scaleHeight; sH++) {
-			for (uint32 x = 0; x < fWidth; x++) {
-				uint32 xP = MAX<int32>((x >> 2) - 1, 0);
-				uint32 xN = MIN<int32>((x >> 2) + 1, chromaWidth - 1);
-
-				byte cY = srcY[x];
-				byte cU = srcU[x >> 2];
-				byte cV = srcV[x >> 2];
-
-				if        (((x % 4) == 0) && ((y % 4) == 0)) {
-					cU = (((uint32) cU) + ((uint32) srcUP[xP])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcVP[xP])) / 2;
-				} else if (((x % 4) == 3) && ((y % 4) == 0)) {
-					cU = (((uint32) cU) + ((uint32) srcUP[xN])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcVP[xN])) / 2;
-				} else if (((x % 4) == 0) && ((y % 4) == 3)) {
-					cU = (((uint32) cU) + ((uint32) srcUN[xP])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcVN[xP])) / 2;
-				} else if (((x % 4) == 3) && ((y % 4) == 3)) {
-					cU = (((uint32) cU) + ((uint32) srcUN[xN])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcVN[xN])) / 2;
-				} else if ( (x % 4) == 0) {
-					cU = (((uint32) cU) + ((uint32) srcU[xP])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcV[xP])) / 2;
-				} else if ( (x % 4) == 3) {
-					cU = (((uint32) cU) + ((uint32) srcU[xN])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcV[xN])) / 2;
-				} else if ( (y % 4) == 0) {
-					cU = (((uint32) cU) + ((uint32) srcUP[x >> 2])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcVP[x >> 2])) / 2;
-				} else if ( (y % 4) == 3) {
-					cU = (((uint32) cU) + ((uint32) srcUN[x >> 2])) / 2;
-					cV = (((uint32) cV) + ((uint32) srcVN[x >> 2])) / 2;
-				}
+		// The chroma of the first and last line of a 4x4 block is blended
+		// with the neighbouring block row, the middle two lines are alike
+		if        ((y % 4) == 0) {
+			interpolateChroma(_lineU, srcU, srcUP, fWidth, chromaWidth);
+			interpolateChroma(_lineV, srcV, srcVP, fWidth, chromaWidth);
+		} else if ((y % 4) == 3) {
+			interpolateChroma(_lineU, srcU, srcUN, fWidth, chromaWidth);
+			interpolateChroma(_lineV, srcV, srcVN, fWidth, chromaWidth);
+		} else if ((y % 4) == 1) {
+			interpolateChroma(_lineU, srcU, 0, fWidth, chromaWidth);
+			interpolateChroma(_lineV, srcV, 0, fWidth, chromaWidth);
+		}
 
-				byte r = 0, g = 0, b = 0;
-				Graphics::YUV2RGB(cY, cU, cV, r, g, b);
+		_yuvConverter->convertLine(dest, srcY, _lineU, _lineV, fWidth);
 
-				const uint32 color = _pixelFormat.RGBToColor(r, g, b);
+		if (scaleWidth > 1) {
+			// Widen the line from right to left, in place
+			const uint32 bpp = _surface->bytesPerPixel;
+			for (int32 x = fWidth - 1; x >= 0; x--)
+				for (int32 sW = scaleWidth - 1; sW >= 0; sW--)
+					memmove(dest + (x * scaleWidth + sW) * bpp, dest + x * bpp, bpp);
+		}
 
-				for (uint32 sW = 0; sW < scaleWidth; sW++, rowDest += _surface->bytesPerPixel) {
-					if      (_surface->bytesPerPixel == 1)
-						*((uint8 *)rowDest) = (uint8)color;
-					else if (_surface->bytesPerPixel == 2)
-						*((uint16 *)rowDest) = (uint16)color;
-				}
-			}
+		for (uint32 sH = 1; sH < scaleHeight; sH++)
+			memcpy(dest + sH * _surface->pitch, dest, fWidth * scaleWidth * _surface->bytesPerPixel);
 
-			dest += _surface->pitch;
-		}
+		dest += _surface->pitch * scaleHeight;
 
 		srcY += fWidth;
 
@@ -353,6 +342,32 @@ const Graphics::Surface *Indeo3Decoder::decodeImage(Common::SeekableReadStream *
 	return _surface;
 }
 
+void Indeo3Decoder::interpolateChroma(byte *dst, const byte *src, const byte *srcNeighbour,
+		uint32 width, uint32 chromaWidth) const {
+
+	// Every chroma sample covers 4 pixels. The outer two of them are blended
+	// with the sample left or right of it. On the first and last line of a
+	// block, all four are blended with the neighbouring block row instead,
+	// the outer two with the sample diagonally next to it.
+	const uint32 count = (width + 3) >> 2;
+
+	for (uint32 x = 0; x < count; x++, dst += 4) {
+		const uint32 xP = (x > 0) ? (x - 1) : 0;
+		const uint32 xN = MIN<uint32>(x + 1, chromaWidth - 1);
+		const uint32 c = src[x];
+
+		if (srcNeighbour) {
+			dst[0] = (c + srcNeighbour[xP]) / 2;
+			dst[1] = dst[2] = (c + srcNeighbour[x]) / 2;
+			dst[3] = (c + srcNeighbour[xN]) / 2;
+		} else {
+			dst[0] = (c + src[xP]) / 2;
+			dst[1] = dst[2] = c;
+			dst[3] = (c + src[xN]) / 2;
+		}
+	}
+}
+
 typedef struct {
 	int32 xpos;
 	int32 ypos;
@@ -39,6 +39,10 @@
 
 #include "video/codecs/codec.h"
 
+namespace Graphics {
+class YUVToRGB;
+}
+
 namespace Video {
 
 class Indeo3Decoder : public Codec {
@@ -79,9 +83,17 @@ private:
 	byte *_ModPred;
 	uint16 *_corrector_type;
 
+	Graphics::YUVToRGB *_yuvConverter;
+
+	// Interpolated chroma of one output line, for _yuvConverter
+	byte *_lineU;
+	byte *_lineV;
+
 	void buildModPred();
 	void allocFrames();
 
+	void interpolateChroma(byte *dst, const byte *src, const byte *srcNeighbour, uint32 width, uint32 chromaWidth) const;
+
 	void decodeChunk(byte *cur, byte *ref, int width, int height,
 			const byte *buf1, uint32 fflags2, const byte *hdr,
 			const byte *buf2, int min_width_160);
@@ -27,7 +27,8 @@
 // in turn appears to be derived from mpeg_play. The following copyright
 // notices have been included in accordance with the original license. Please
 // note that the term "software" in this context only applies to the
-// buildLookup() and plotYUV*() functions below.
+// buildLookup() functions below, and the kColorSpaceMPEG conversion of
+// graphics/yuv_to_rgb.cpp.
 
 // Copyright (c) 1995 The Regents of the University of California.
 // All rights reserved.
@@ -92,6 +93,8 @@
 #include "common/util.h"
 #include "common/textconsole.h"
 
+#include "graphics/yuv_to_rgb.h"
+
 namespace Video {
 
 BaseAnimationState::BaseAnimationState(OSystem *sys, int width, int height)
@@ -106,9 +109,7 @@ BaseAnimationState::BaseAnimationState(OSystem *sys, int width, int height)
 	if (_movieScale > 3)
 		_movieScale = 3;
 
-	_colorTab = NULL;
-	_rgbToPix = NULL;
-	memset(&_overlayFormat, 0, sizeof(_overlayFormat));
+	_yuvConverter = NULL;
 #endif
 }
 
@@ -120,8 +121,7 @@ BaseAnimationState::~BaseAnimationState() {
 #ifndef BACKEND_8BIT
 	_sys->hideOverlay();
 	free(_overlay);
-	free(_colorTab);
-	free(_rgbToPix);
+	delete _yuvConverter;
 #endif
 #endif
 }
@@ -349,258 +349,35 @@ void BaseAnimationState::buildLookup(int p, int lines) {
 #else
 
 void BaseAnimationState::buildLookup() {
-	// Do we already have lookup tables for this bit format?
+	// Do we already have a converter for this bit format?
 	Graphics::PixelFormat format = _sys->getOverlayFormat();
-	if (format == _overlayFormat && _colorTab && _rgbToPix)
+	if (_yuvConverter && format == _yuvConverter->getFormat())
 		return;
 
-	free(_colorTab);
-	free(_rgbToPix);
-
-	_colorTab = (int16 *)malloc(4 * 256 * sizeof(int16));
-
-	int16 *Cr_r_tab = &_colorTab[0 * 256];
-	int16 *Cr_g_tab = &_colorTab[1 * 256];
-	int16 *Cb_g_tab = &_colorTab[2 * 256];
-	int16 *Cb_b_tab = &_colorTab[3 * 256];
-
-	_rgbToPix = (OverlayColor *)malloc(3 * 768 * sizeof(OverlayColor));
-
-	OverlayColor *r_2_pix_alloc = &_rgbToPix[0 * 768];
-	OverlayColor *g_2_pix_alloc = &_rgbToPix[1 * 768];
-	OverlayColor *b_2_pix_alloc = &_rgbToPix[2 * 768];
-
-	int16 CR, CB;
-	int i;
-
-	// Generate the tables for the display surface
-
-	for (i = 0; i < 256; i++) {
-		// Gamma correction (luminescence table) and chroma correction
-		// would be done here. See the Berkeley mpeg_play sources.
-
-		CR = CB = (i - 128);
-		Cr_r_tab[i] = (int16) ( (0.419 / 0.299) * CR) + 0 * 768 + 256;
-		Cr_g_tab[i] = (int16) (-(0.299 / 0.419) * CR) + 1 * 768 + 256;
-		Cb_g_tab[i] = (int16) (-(0.114 / 0.331) * CB);
-		Cb_b_tab[i] = (int16) ( (0.587 / 0.331) * CB) + 2 * 768 + 256;
-	}
-
-	// Set up entries 0-255 in rgb-to-pixel value tables.
-	for (i = 0; i < 256; i++) {
-		r_2_pix_alloc[i + 256] = format.RGBToColor(i, 0, 0);
-		g_2_pix_alloc[i + 256] = format.RGBToColor(0, i, 0);
-		b_2_pix_alloc[i + 256] = format.RGBToColor(0, 0, i);
-	}
-
-	// Spread out the values we have to the rest of the array so that we do
-	// not need to check for overflow.
-	for (i = 0; i < 256; i++) {
-		r_2_pix_alloc[i] = r_2_pix_alloc[256];
-		r_2_pix_alloc[i + 512] = r_2_pix_alloc[511];
-		g_2_pix_alloc[i] = g_2_pix_alloc[256];
-		g_2_pix_alloc[i + 512] = g_2_pix_alloc[511];
-		b_2_pix_alloc[i] = b_2_pix_alloc[256];
-		b_2_pix_alloc[i + 512] = b_2_pix_alloc[511];
-	}
-
-	_overlayFormat = format;
+	delete _yuvConverter;
+	_yuvConverter = new Graphics::YUVToRGB(format, Graphics::YUVToRGB::kColorSpaceMPEG);
 }
 
 void BaseAnimationState::plotYUV(int width, int height, byte *const *dat) {
-	switch (_movieScale) {
-	case 1:
-		plotYUV1x(width, height, dat);
-		break;
-	case 2:
-		plotYUV2x(width, height, dat);
-		break;
-	case 3:
-		plotYUV3x(width, height, dat);
-		break;
-	}
-}
-
-void BaseAnimationState::plotYUV1x(int width, int height, byte *const *dat) {
-	byte *lum = dat[0];
-	byte *cr = dat[2];
-	byte *cb = dat[1];
-
-	byte *lum2 = lum + width;
-
-	int16 cr_r;
-	int16 crb_g;
-	int16 cb_b;
-
-	OverlayColor *row1 = _overlay;
-	OverlayColor *row2 = row1 + _movieWidth;
-
-	int x;
-
-	for (; height > 0; height -= 2) {
-		OverlayColor *r1 = row1;
-		OverlayColor *r2 = row2;
-
-		for (x = width; x > 0; x -= 2) {
-			register OverlayColor *L;
-
-			cr_r  = _colorTab[*cr + 0 * 256];
-			crb_g = _colorTab[*cr + 1 * 256] + _colorTab[*cb + 2 * 256];
-			cb_b  = _colorTab[*cb + 3 * 256];
-			++cr;
-			++cb;
-
-			L = &_rgbToPix[*lum++];
-			*r1++ = L[cr_r] | L[crb_g] | L[cb_b];
+	const int pitch = _movieScale * _movieWidth;
 
-			L = &_rgbToPix[*lum++];
-			*r1++ = L[cr_r] | L[crb_g] | L[cb_b];
+	// Convert every line into the first of the lines it is scaled to
+	_yuvConverter->convert420((byte *)_overlay, _movieScale * pitch * sizeof(OverlayColor),
+			dat[0], dat[1], dat[2], width, height, width, width / 2);
 
-			// Now, do second row.
-
-			L = &_rgbToPix[*lum2++];
-			*r2++ = L[cr_r] | L[crb_g] | L[cb_b];
-
-			L = &_rgbToPix[*lum2++];
-			*r2++ = L[cr_r] | L[crb_g] | L[cb_b];
-		}
-
-		lum  += width;
-		lum2 += width;
-		row1 += 2 * _movieWidth;
-		row2 += 2 * _movieWidth;
-	}
-}
-
-void BaseAnimationState::plotYUV2x(int width, int height, byte *const *dat) {
-	byte *lum = dat[0];
-	byte *cr = dat[2];
-	byte *cb = dat[1];
-
-	byte *lum2 = lum + width;
-
-	int16 cr_r;
-	int16 crb_g;
-	int16 cb_b;
-
-	OverlayColor *row1 = _overlay;
-	OverlayColor *row2 = row1 + 2 * 2 * _movieWidth;
-
-	int x;
-
-	for (; height > 0; height -= 2) {
-		OverlayColor *r1 = row1;
-		OverlayColor *r2 = row2;
-
-		for (x = width; x > 0; x -= 2) {
-			register OverlayColor *L;
-			register OverlayColor  C;
-
-			cr_r  = _colorTab[*cr + 0 * 256];
-			crb_g = _colorTab[*cr + 1 * 256] + _colorTab[*cb + 2 * 256];
-			cb_b  = _colorTab[*cb + 3 * 256];
-			++cr;
-			++cb;
-
-			L = &_rgbToPix[*lum++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r1++ = C;
-			*r1++ = C;
-
-			L = &_rgbToPix[*lum++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r1++ = C;
-			*r1++ = C;
-
-			// Now, do second row.
-
-			L = &_rgbToPix[*lum2++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r2++ = C;
-			*r2++ = C;
-
-			L = &_rgbToPix[*lum2++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r2++ = C;
-			*r2++ = C;
-		}
-
-		memcpy(row1 + 2 * _movieWidth, row1, 2 * _movieWidth * sizeof(OverlayColor));
-		memcpy(row2 + 2 * _movieWidth, row2, 2 * _movieWidth * sizeof(OverlayColor));
-
-		lum  += width;
-		lum2 += width;
-		row1 += 4 * 2 * _movieWidth;
-		row2 += 4 * 2 * _movieWidth;
-	}
-}
+	if (_movieScale == 1)
+		return;
 
-void BaseAnimationState::plotYUV3x(int width, int height, byte *const *dat) {
-	byte *lum = dat[0];
-	byte *cr = dat[2];
-	byte *cb = dat[1];
-
-	byte *lum2 = lum + width;
-
-	int16 cr_r;
-	int16 crb_g;
-	int16 cb_b;
-
-	OverlayColor *row1 = _overlay;
-	OverlayColor *row2 = row1 + 3 * 3 * _movieWidth;
-
-	int x;
-
-	for (; height > 0; height -= 2) {
-		OverlayColor *r1 = row1;
-		OverlayColor *r2 = row2;
-
-		for (x = width; x > 0; x -= 2) {
-			register OverlayColor *L;
-			register OverlayColor  C;
-
-			cr_r  = _colorTab[*cr + 0 * 256];
-			crb_g = _colorTab[*cr + 1 * 256] + _colorTab[*cb + 2 * 256];
-			cb_b  = _colorTab[*cb + 3 * 256];
-			++cr;
-			++cb;
-
-			L = &_rgbToPix[*lum++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r1++ = C;
-			*r1++ = C;
-			*r1++ = C;
-
-			L = &_rgbToPix[*lum++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r1++ = C;
-			*r1++ = C;
-			*r1++ = C;
-
-			// Now, do second row.
-
-			L = &_rgbToPix[*lum2++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r2++ = C;
-			*r2++ = C;
-			*r2++ = C;
-
-			L = &_rgbToPix[*lum2++];
-			C = L[cr_r] | L[crb_g] | L[cb_b];
-			*r2++ = C;
-			*r2++ = C;
-			*r2++ = C;
-		}
+	for (int y = 0; y < height; y++) {
+		OverlayColor *row = _overlay + y * _movieScale * pitch;
 
-		memcpy(row1 + 3 * _movieWidth, row1, 3 * _movieWidth * sizeof(OverlayColor));
-		memcpy(row1 + 2 * 3 * _movieWidth, row1, 3 * _movieWidth * sizeof(OverlayColor));
-		memcpy(row2 + 3 * _movieWidth, row2, 3 * _movieWidth * sizeof(OverlayColor));
-		memcpy(row2 + 2 * 3 * _movieWidth, row2, 3 * _movieWidth * sizeof(OverlayColor));
+		// Widen the line from right to left, in place
+		for (int x = width - 1; x >= 0; x--)
+			for (int s = _movieScale - 1; s >= 0; s--)
+				row[x * _movieScale + s] = row[x];
 
-		lum  += width;
-		lum2 += width;
-		row1 += 6 * 3 * _movieWidth;
-		row2 += 6 * 3 * _movieWidth;
+		for (int s = 1; s < _movieScale; s++)
+			memcpy(row + s * pitch, row, _movieScale * width * sizeof(OverlayColor));
 	}
 }
 
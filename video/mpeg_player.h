@@ -84,6 +84,10 @@ namespace Common {
 class File;
 }
 
+namespace Graphics {
+class YUVToRGB;
+}
+
 class OSystem;
 
 namespace Video {
@@ -131,9 +135,7 @@ protected:
 	} _palettes[50];
 #else
 	OverlayColor *_overlay;
-	Graphics::PixelFormat _overlayFormat;
-	int16 *_colorTab;
-	OverlayColor *_rgbToPix;
+	Graphics::YUVToRGB *_yuvConverter;
 #endif
 
 public:
@@ -161,9 +163,6 @@ protected:
 	virtual void setPalette(byte *pal) = 0;
 #else
 	void plotYUV(int width, int height, byte *const *dat);
-	void plotYUV1x(int width, int height, byte *const *dat);
-	void plotYUV2x(int width, int height, byte *const *dat);
-	void plotYUV3x(int width, int height, byte *const *dat);
 #endif
 };
 
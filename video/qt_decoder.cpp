@@ -85,6 +85,12 @@ QuickTimeDecoder::QuickTimeDecoder() {
 	_dirtyPalette = false;
 	_resFork = new Common::MacResManager();
 	_palette = 0;
+	_videoSamples = 0;
+	_videoSampleCount = 0;
+	_sampleBuffer = 0;
+	_sampleBufferSize = 0;
+	_sampleBufferOffset = 0;
+	_sampleBufferLength = 0;
 
 	initParseTable();
 }
@@ -535,6 +541,8 @@ void QuickTimeDecoder::init() {
 			entry->videoCodec = createCodec(entry->codecTag, entry->bitsPerSample & 0x1F);
 		}
 
+		buildVideoSampleTable();
+
 		if (getScaleFactorX() != 1 || getScaleFactorY() != 1) {
 			// We have to initialize the scaled surface
 			_scaledSurface = new Graphics::Surface();
@@ -1262,6 +1270,16 @@ void QuickTimeDecoder::close() {
 	delete _fd;
 	_fd = 0;
 
+	delete[] _videoSamples;
+	_videoSamples = 0;
+	_videoSampleCount = 0;
+
+	delete[] _sampleBuffer;
+	_sampleBuffer = 0;
+	_sampleBufferSize = 0;
+	_sampleBufferOffset = 0;
+	_sampleBufferLength = 0;
+
 	if (_scaledSurface) {
 		_scaledSurface->free();
 		delete _scaledSurface;
@@ -1274,58 +1292,105 @@ void QuickTimeDecoder::close() {
 	SeekableVideoDecoder::reset();
 }
 
-Common::SeekableReadStream *QuickTimeDecoder::getNextFramePacket(uint32 &descId) {
-	if (_videoStreamIndex < 0)
-		return NULL;
+void QuickTimeDecoder::buildVideoSampleTable() {
+	MOVStreamContext *sc = _streams[_videoStreamIndex];
 
-	// First, we have to track down which chunk holds the sample and which sample in the chunk contains the frame we are looking for.
-	int32 totalSampleCount = 0;
-	int32 sampleInChunk = 0;
-	int32 actualChunk = -1;
+	delete[] _videoSamples;
 
-	for (uint32 i = 0; i < _streams[_videoStreamIndex]->chunk_count; i++) {
+	// Count the samples in all chunks first
+	uint32 sampleCount = 0;
+	for (uint32 i = 0; i < sc->chunk_count; i++) {
 		int32 sampleToChunkIndex = -1;
 
-		for (uint32 j = 0; j < _streams[_videoStreamIndex]->sample_to_chunk_sz; j++)
-			if (i >= _streams[_videoStreamIndex]->sample_to_chunk[j].first)
+		for (uint32 j = 0; j < sc->sample_to_chunk_sz; j++)
+			if (i >= sc->sample_to_chunk[j].first)
 				sampleToChunkIndex = j;
 
 		if (sampleToChunkIndex < 0)
 			error("This chunk (%d) is imaginary", sampleToChunkIndex);
 
-		totalSampleCount += _streams[_videoStreamIndex]->sample_to_chunk[sampleToChunkIndex].count;
+		sampleCount += sc->sample_to_chunk[sampleToChunkIndex].count;
+	}
 
-		if (totalSampleCount > getCurFrame()) {
-			actualChunk = i;
-			descId = _streams[_videoStreamIndex]->sample_to_chunk[sampleToChunkIndex].id;
-			sampleInChunk = _streams[_videoStreamIndex]->sample_to_chunk[sampleToChunkIndex].count - totalSampleCount + getCurFrame();
-			break;
+	// Without a fixed sample size, there are only sizes for sample_count samples
+	if (sc->sample_size == 0)
+		sampleCount = MIN(sampleCount, sc->sample_count);
+
+	_videoSamples = new VideoSample[sampleCount];
+	_videoSampleCount = sampleCount;
+
+	uint32 sample = 0;
+	for (uint32 i = 0; i < sc->chunk_count && sample < sampleCount; i++) {
+		int32 sampleToChunkIndex = -1;
+
+		for (uint32 j = 0; j < sc->sample_to_chunk_sz; j++)
+			if (i >= sc->sample_to_chunk[j].first)
+				sampleToChunkIndex = j;
+
+		// The samples of a chunk follow each other in the file
+		uint32 offset = sc->chunk_offsets[i];
+		for (uint32 j = 0; j < sc->sample_to_chunk[sampleToChunkIndex].count && sample < sampleCount; j++, sample++) {
+			_videoSamples[sample].offset = offset;
+			_videoSamples[sample].size = (sc->sample_size != 0) ? sc->sample_size : sc->sample_sizes[sample];
+			_videoSamples[sample].descId = sc->sample_to_chunk[sampleToChunkIndex].id;
+			offset += _videoSamples[sample].size;
 		}
 	}
+}
 
-	if (actualChunk < 0) {
-		warning ("Could not find data for frame %d", getCurFrame());
-		return NULL;
+void QuickTimeDecoder::readAheadVideoSamples(uint32 frame) {
+	// Limit for the amount of data read ahead of the current frame
+	static const uint32 kReadAheadSize = 256 * 1024;
+
+	const uint32 start = _videoSamples[frame].offset;
+	uint32 end = start + _videoSamples[frame].size;
+
+	// Include the following frames as long as they are stored further on
+	// in the file. Anything in between, usually interleaved audio, is
+	// read as well, which is still cheaper than seeking back and forth.
+	for (uint32 i = frame + 1; i < _videoSampleCount; i++) {
+		const VideoSample &sample = _videoSamples[i];
+
+		if (sample.offset < end || sample.offset + sample.size - start > kReadAheadSize)
+			break;
+
+		end = sample.offset + sample.size;
+	}
+
+	if (end - start > _sampleBufferSize) {
+		delete[] _sampleBuffer;
+		_sampleBufferSize = end - start;
+		_sampleBuffer = new byte[_sampleBufferSize];
 	}
 
-	// Next seek to that frame
-	_fd->seek(_streams[_videoStreamIndex]->chunk_offsets[actualChunk]);
+	_fd->seek(start);
+	_sampleBufferOffset = start;
+	_sampleBufferLength = _fd->read(_sampleBuffer, end - start);
+}
+
+Common::SeekableReadStream *QuickTimeDecoder::getNextFramePacket(uint32 &descId) {
+	if (_videoStreamIndex < 0)
+		return NULL;
 
-	// Then, if the chunk holds more than one frame, seek to where the frame we want is located
-	for (int32 i = getCurFrame() - sampleInChunk; i < getCurFrame(); i++) {
-		if (_streams[_videoStreamIndex]->sample_size != 0)
-			_fd->skip(_streams[_videoStreamIndex]->sample_size);
-		else
-			_fd->skip(_streams[_videoStreamIndex]->sample_sizes[i]);
+	if ((uint32)getCurFrame() >= _videoSampleCount) {
+		warning ("Could not find data for frame %d", getCurFrame());
+		return NULL;
 	}
 
-	// Finally, read in the raw data for the frame
-	//printf ("Frame Data[%d]: Offset = %d, Size = %d\n", getCurFrame(), _fd->pos(), _streams[_videoStreamIndex]->sample_sizes[getCurFrame()]);
+	const VideoSample &sample = _videoSamples[getCurFrame()];
+	descId = sample.descId;
+
+	const uint32 bufferEnd = _sampleBufferOffset + _sampleBufferLength;
+	if (sample.offset < _sampleBufferOffset || sample.offset + sample.size > bufferEnd)
+		readAheadVideoSamples(getCurFrame());
 
-	if (_streams[_videoStreamIndex]->sample_size != 0)
-		return _fd->readStream(_streams[_videoStreamIndex]->sample_size);
+	// The sample may be cut short at the end of the file
+	uint32 size = 0;
+	if (sample.offset < _sampleBufferOffset + _sampleBufferLength)
+		size = MIN(sample.size, _sampleBufferOffset + _sampleBufferLength - sample.offset);
 
-	return _fd->readStream(_streams[_videoStreamIndex]->sample_sizes[getCurFrame()]);
+	// The data stays valid until the next call, which is enough for the codecs
+	return new Common::MemoryReadStream(_sampleBuffer + (sample.offset - _sampleBufferOffset), size);
 }
 
 bool QuickTimeDecoder::checkAudioCodecSupport(uint32 tag) {
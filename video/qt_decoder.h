@@ -266,6 +266,25 @@ private:
 	int8 _videoStreamIndex;
 	uint32 findKeyFrame(uint32 frame) const;
 
+	// Location of every video frame in the file, built by init()
+	struct VideoSample {
+		uint32 offset;
+		uint32 size;
+		uint32 descId;
+	};
+
+	VideoSample *_videoSamples;
+	uint32 _videoSampleCount;
+	void buildVideoSampleTable();
+
+	// Video samples are read from the file in larger blocks, covering the
+	// current frame and the ones following it
+	byte *_sampleBuffer;
+	uint32 _sampleBufferSize;
+	uint32 _sampleBufferOffset;
+	uint32 _sampleBufferLength;
+	void readAheadVideoSamples(uint32 frame);
+
 	Graphics::Surface *_scaledSurface;
 	const Graphics::Surface *scaleSurface(const Graphics::Surface *frame);
 	Common::Rational getScaleFactorX() const;
@@ -56,66 +56,77 @@ enum SmkBlockTypes {
 class BitStream {
 public:
 	BitStream(byte *buf, uint32 length)
-		: _buf(buf), _end(buf+length), _bitCount(8) {
-		_curByte = *_buf++;
+		: _buf(buf), _end(buf+length), _bitBuf(0), _bitCount(0) {
+		refill();
 	}
 
 	bool getBit();
 	byte getBits8();
 
-	byte peek8() const;
+	uint32 peekBits(int n);
 	void skip(int n);
 
 private:
+	void refill();
+
 	byte *_buf;
 	byte *_end;
-	byte _curByte;
-	byte  _bitCount;
+	uint32 _bitBuf;
+	int _bitCount;
 };
 
+void BitStream::refill() {
+	while (_bitCount <= 24 && _buf < _end) {
+		_bitBuf |= (uint32)*_buf++ << _bitCount;
+		_bitCount += 8;
+	}
+}
+
 bool BitStream::getBit() {
 	if (_bitCount == 0) {
-		assert(_buf < _end);
-		_curByte = *_buf++;
-		_bitCount = 8;
+		refill();
+		assert(_bitCount);
 	}
 
-	bool v = _curByte & 1;
+	bool v = _bitBuf & 1;
 
-	_curByte >>= 1;
+	_bitBuf >>= 1;
 	--_bitCount;
 
 	return v;
 }
 
 byte BitStream::getBits8() {
-	assert(_buf < _end);
+	if (_bitCount < 8) {
+		refill();
+		assert(_bitCount >= 8);
+	}
+
+	byte v = _bitBuf & 0xff;
 
-	byte v = (*_buf << _bitCount) | _curByte;
-	_curByte = *_buf++ >> (8 - _bitCount);
+	_bitBuf >>= 8;
+	_bitCount -= 8;
 
 	return v;
 }
 
-byte BitStream::peek8() const {
-	if (_buf == _end)
-		return _curByte;
+uint32 BitStream::peekBits(int n) {
+	assert(n <= 24);
+	if (_bitCount < n)
+		refill();
 
-	assert(_buf < _end);
-	return (*_buf << _bitCount) | _curByte;
+	// Past the end of the stream, the missing bits read as zero
+	return _bitBuf & ((1 << n) - 1);
 }
 
 void BitStream::skip(int n) {
-	assert(n <= 8);
-	_curByte >>= n;
-
-	if (_bitCount >= n) {
-		_bitCount -= n;
-	} else {
-		assert(_buf < _end);
-		_bitCount = _bitCount + 8 - n;
-		_curByte = *_buf++ >> (8 - _bitCount);
+	if (_bitCount < n) {
+		refill();
+		assert(_bitCount >= n);
 	}
+
+	_bitBuf >>= n;
+	_bitCount -= n;
 }
 
 /*
@@ -130,16 +141,21 @@ public:
 	uint16 getCode(BitStream &bs);
 private:
 	enum {
-		SMK_NODE = 0x8000
+		SMK_NODE = 0x8000,
+		// Codes up to this length are decoded with a single table lookup
+		kLookupBits = 10
 	};
 
-	uint16 decodeTree(uint32 prefix, int length);
+	uint16 decodeTree();
+	void fillLookup(uint16 index, uint32 prefix, int length);
 
 	uint16 _treeSize;
 	uint16 _tree[511];
 
-	uint16 _prefixtree[256];
-	byte _prefixlength[256];
+	// Indexed by the next kLookupBits bits of the stream: the value and
+	// (shifted by 8) the length of codes which fit, or SMK_NODE and the
+	// tree node to continue at for longer codes.
+	uint16 _lookup[1 << kLookupBits];
 
 	BitStream &_bs;
 };
@@ -149,25 +165,17 @@ SmallHuffmanTree::SmallHuffmanTree(BitStream &bs)
 	uint32 bit = _bs.getBit();
 	assert(bit);
 
-	for (uint16 i = 0; i < 256; ++i)
-		_prefixtree[i] = _prefixlength[i] = 0;
-
-	decodeTree(0, 0);
+	decodeTree();
 
 	bit = _bs.getBit();
 	assert(!bit);
+
+	fillLookup(0, 0, 0);
 }
 
-uint16 SmallHuffmanTree::decodeTree(uint32 prefix, int length) {
+uint16 SmallHuffmanTree::decodeTree() {
 	if (!_bs.getBit()) { // Leaf
 		_tree[_treeSize] = _bs.getBits8();
-
-		if (length <= 8) {
-			for (int i = 0; i < 256; i += (1 << length)) {
-				_prefixtree[prefix | i] = _treeSize;
-				_prefixlength[prefix | i] = length;
-			}
-		}
 		++_treeSize;
 
 		return 1;
@@ -175,24 +183,41 @@ uint16 SmallHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 	uint16 t = _treeSize++;
 
-	if (length == 8) {
-		_prefixtree[prefix] = t;
-		_prefixlength[prefix] = 8;
-	}
-
-	uint16 r1 = decodeTree(prefix, length + 1);
+	uint16 r1 = decodeTree();
 
 	_tree[t] = (SMK_NODE | r1);
 
-	uint16 r2 = decodeTree(prefix | (1 << length), length + 1);
+	uint16 r2 = decodeTree();
 
 	return r1+r2+1;
 }
 
+void SmallHuffmanTree::fillLookup(uint16 index, uint32 prefix, int length) {
+	if (!(_tree[index] & SMK_NODE)) {
+		for (uint32 i = prefix; i < (1 << kLookupBits); i += (1 << length))
+			_lookup[i] = _tree[index] | (length << 8);
+		return;
+	}
+
+	if (length == kLookupBits) {
+		_lookup[prefix] = SMK_NODE | index;
+		return;
+	}
+
+	fillLookup(index + 1, prefix, length + 1);
+	fillLookup(index + 1 + (_tree[index] & ~SMK_NODE), prefix | (1 << length), length + 1);
+}
+
 uint16 SmallHuffmanTree::getCode(BitStream &bs) {
-	byte peek = bs.peek8();
-	uint16 *p = &_tree[_prefixtree[peek]];
-	bs.skip(_prefixlength[peek]);
+	uint16 entry = _lookup[bs.peekBits(kLookupBits)];
+
+	if (!(entry & SMK_NODE)) {
+		bs.skip(entry >> 8);
+		return entry & 0xff;
+	}
+
+	bs.skip(kLookupBits);
+	uint16 *p = &_tree[entry & ~SMK_NODE];
 
 	while (*p & SMK_NODE) {
 		if (bs.getBit())
@@ -217,17 +242,23 @@ public:
 	uint32 getCode(BitStream &bs);
 private:
 	enum {
-		SMK_NODE = 0x80000000
+		SMK_NODE = 0x80000000,
+		// Codes up to this length are decoded with a single table lookup
+		kLookupBits = 12
 	};
 
-	uint32 decodeTree(uint32 prefix, int length);
+	uint32 decodeTree();
+	void fillLookup(uint32 index, uint32 prefix, int length);
 
 	uint32  _treeSize;
 	uint32 *_tree;
 	uint32  _last[3];
 
-	uint32 _prefixtree[256];
-	byte _prefixlength[256];
+	// Indexed by the next kLookupBits bits of the stream: the tree index
+	// of the leaf and (shifted by 24) the length of codes which fit, or
+	// SMK_NODE and the tree node to continue at for longer codes. Leaves
+	// are referenced rather than stored, as the _last ones change.
+	uint32 _lookup[1 << kLookupBits];
 
 	/* Used during construction */
 	BitStream &_bs;
@@ -243,12 +274,10 @@ BigHuffmanTree::BigHuffmanTree(BitStream &bs, int allocSize)
 		_tree = new uint32[1];
 		_tree[0] = 0;
 		_last[0] = _last[1] = _last[2] = 0;
+		fillLookup(0, 0, 0);
 		return;
 	}
 
-	for (uint32 i = 0; i < 256; ++i)
-		_prefixtree[i] = _prefixlength[i] = 0;
-
 	_loBytes = new SmallHuffmanTree(_bs);
 	_hiBytes = new SmallHuffmanTree(_bs);
 
@@ -261,9 +290,10 @@ BigHuffmanTree::BigHuffmanTree(BitStream &bs, int allocSize)
 
 	_last[0] = _last[1] = _last[2] = 0xffffffff;
 
+	assert(allocSize / 4 < (1 << 24));
 	_treeSize = 0;
 	_tree = new uint32[allocSize / 4];
-	decodeTree(0, 0);
+	decodeTree();
 	bit = _bs.getBit();
 	assert(!bit);
 
@@ -274,6 +304,8 @@ BigHuffmanTree::BigHuffmanTree(BitStream &bs, int allocSize)
 		}
 	}
 
+	fillLookup(0, 0, 0);
+
 	delete _loBytes;
 	delete _hiBytes;
 }
@@ -287,7 +319,7 @@ void BigHuffmanTree::reset() {
 	_tree[_last[0]] = _tree[_last[1]] = _tree[_last[2]] = 0;
 }
 
-uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
+uint32 BigHuffmanTree::decodeTree() {
 	uint32 bit = _bs.getBit();
 
 	if (!bit) { // Leaf
@@ -298,13 +330,6 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 		_tree[_treeSize] = v;
 
-		if (length <= 8) {
-			for (int i = 0; i < 256; i += (1 << length)) {
-				_prefixtree[prefix | i] = _treeSize;
-				_prefixlength[prefix | i] = length;
-			}
-		}
-
 		for (int i = 0; i < 3; ++i) {
 			if (_markers[i] == v) {
 				_last[i] = _treeSize;
@@ -318,28 +343,46 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 	uint32 t = _treeSize++;
 
-	if (length == 8) {
-		_prefixtree[prefix] = t;
-		_prefixlength[prefix] = 8;
-	}
-
-	uint32 r1 = decodeTree(prefix, length + 1);
+	uint32 r1 = decodeTree();
 
 	_tree[t] = SMK_NODE | r1;
 
-	uint32 r2 = decodeTree(prefix | (1 << length), length + 1);
+	uint32 r2 = decodeTree();
 	return r1+r2+1;
 }
 
+void BigHuffmanTree::fillLookup(uint32 index, uint32 prefix, int length) {
+	if (!(_tree[index] & SMK_NODE)) {
+		for (uint32 i = prefix; i < (1 << kLookupBits); i += (1 << length))
+			_lookup[i] = index | (length << 24);
+		return;
+	}
+
+	if (length == kLookupBits) {
+		_lookup[prefix] = SMK_NODE | index;
+		return;
+	}
+
+	fillLookup(index + 1, prefix, length + 1);
+	fillLookup(index + 1 + (_tree[index] & ~SMK_NODE), prefix | (1 << length), length + 1);
+}
+
 uint32 BigHuffmanTree::getCode(BitStream &bs) {
-	byte peek = bs.peek8();
-	uint32 *p = &_tree[_prefixtree[peek]];
-	bs.skip(_prefixlength[peek]);
+	uint32 entry = _lookup[bs.peekBits(kLookupBits)];
+	uint32 *p;
 
-	while (*p & SMK_NODE) {
-		if (bs.getBit())
-			p += (*p) & ~SMK_NODE;
-		p++;
+	if (!(entry & SMK_NODE)) {
+		bs.skip(entry >> 24);
+		p = &_tree[entry & 0xffffff];
+	} else {
+		bs.skip(kLookupBits);
+		p = &_tree[entry & ~SMK_NODE];
+
+		while (*p & SMK_NODE) {
+			if (bs.getBit())
+				p += (*p) & ~SMK_NODE;
+			p++;
+		}
 	}
 
 	uint32 v = *p;
@@ -25,11 +25,15 @@
 
 #include "video/video_decoder.h"
 
+#include "common/debug.h"
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/textconsole.h"
+#include "common/timer.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
@@ -118,4 +122,275 @@ uint32 FixedRateVideoDecoder::getFrameBeginTime(uint32 frame) const {
 	return beginTime.toInt();
 }
 
+struct DecodeAheadVideoDecoder::QueuedFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	bool dirtyPalette;
+	byte palette[256 * 3];
+	uint32 time;	///< elapsed time at which the frame is due
+};
+
+DecodeAheadVideoDecoder::DecodeAheadVideoDecoder(VideoDecoder *decoder, uint frames) : _decoder(decoder) {
+	assert(_decoder);
+	_numFrames = MAX<uint>(frames, 1);
+	_queue = new QueuedFrame[_numFrames + 1];
+	_queueStart = 0;
+	_queueCount = 0;
+	_nextFrameTime = 0;
+	_decoderFinished = false;
+	_started = false;
+	_timerInstalled = false;
+	_dirtyPalette = false;
+	memset(_palette, 0, sizeof(_palette));
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+DecodeAheadVideoDecoder::~DecodeAheadVideoDecoder() {
+	close();
+	delete[] _queue;
+	delete _decoder;
+}
+
+bool DecodeAheadVideoDecoder::loadFile(const Common::String &filename) {
+	close();
+	return _decoder->loadFile(filename);
+}
+
+bool DecodeAheadVideoDecoder::loadStream(Common::SeekableReadStream *stream) {
+	close();
+	return _decoder->loadStream(stream);
+}
+
+void DecodeAheadVideoDecoder::close() {
+	stopDecodeAhead();
+
+	if (_decoder->isVideoLoaded())
+		_decoder->close();
+
+	for (uint i = 0; i <= _numFrames; i++)
+		_queue[i].surface.free();
+
+	_queueStart = 0;
+	_queueCount = 0;
+	_nextFrameTime = 0;
+	_decoderFinished = false;
+	_dirtyPalette = false;
+	memset(&_stats, 0, sizeof(_stats));
+	reset();
+}
+
+bool DecodeAheadVideoDecoder::isVideoLoaded() const {
+	return _decoder->isVideoLoaded();
+}
+
+uint16 DecodeAheadVideoDecoder::getWidth() const {
+	return _decoder->getWidth();
+}
+
+uint16 DecodeAheadVideoDecoder::getHeight() const {
+	return _decoder->getHeight();
+}
+
+Graphics::PixelFormat DecodeAheadVideoDecoder::getPixelFormat() const {
+	return _decoder->getPixelFormat();
+}
+
+const byte *DecodeAheadVideoDecoder::getPalette() {
+	_dirtyPalette = false;
+	return _palette;
+}
+
+uint32 DecodeAheadVideoDecoder::getFrameCount() const {
+	return _decoder->getFrameCount();
+}
+
+uint32 DecodeAheadVideoDecoder::getElapsedTime() const {
+	return _decoder->getElapsedTime();
+}
+
+uint32 DecodeAheadVideoDecoder::getTimeToNextFrame() const {
+	if (!_started)
+		return 0;
+
+	uint32 nextFrameTime;
+	{
+		Common::StackLock lock(_queueMutex);
+		nextFrameTime = _queueCount ? _queue[_queueStart].time : _nextFrameTime;
+	}
+
+	uint32 elapsedTime = _decoder->getElapsedTime();
+	if (nextFrameTime <= elapsedTime)
+		return 0;
+
+	return nextFrameTime - elapsedTime;
+}
+
+bool DecodeAheadVideoDecoder::endOfVideo() const {
+	if (!isVideoLoaded())
+		return true;
+
+	if (!_started)
+		return _decoder->endOfVideo();
+
+	Common::StackLock lock(_queueMutex);
+	return !_queueCount && _decoderFinished;
+}
+
+const Graphics::Surface *DecodeAheadVideoDecoder::decodeNextFrame() {
+	bool ready;
+	{
+		Common::StackLock lock(_queueMutex);
+		ready = _queueCount != 0;
+	}
+
+	if (!ready) {
+		// Wait for a frame being decoded right now, or decode one here
+		Common::StackLock decoderLock(_decoderMutex);
+
+		{
+			Common::StackLock lock(_queueMutex);
+			ready = _queueCount != 0;
+		}
+
+		if (!ready) {
+			if (_decoder->endOfVideo()) {
+				Common::StackLock lock(_queueMutex);
+				_decoderFinished = true;
+				return 0;
+			}
+
+			// The slot at the start of the queue is never the displayed one
+			decodeFrame(_queue[_queueStart]);
+
+			Common::StackLock lock(_queueMutex);
+			_queueCount++;
+			if (_started)
+				_stats.lateFrames++;
+		}
+	}
+
+	QueuedFrame *frame;
+	{
+		Common::StackLock lock(_queueMutex);
+		frame = &_queue[_queueStart];
+		_queueStart = (_queueStart + 1) % (_numFrames + 1);
+		_queueCount--;
+		_stats.frames++;
+	}
+
+	_curFrame++;
+
+	// The frame is now the displayed one, which decodeAhead() leaves alone
+	if (frame->dirtyPalette) {
+		memcpy(_palette, frame->palette, sizeof(_palette));
+		_dirtyPalette = true;
+	}
+
+	if (!_started)
+		startDecodeAhead();
+
+	return frame->hasSurface ? &frame->surface : 0;
+}
+
+DecodeAheadVideoDecoder::Statistics DecodeAheadVideoDecoder::getStatistics() const {
+	Common::StackLock lock(_queueMutex);
+	return _stats;
+}
+
+void DecodeAheadVideoDecoder::pauseVideoIntern(bool pause) {
+	Common::StackLock lock(_decoderMutex);
+	_decoder->pauseVideo(pause);
+}
+
+void DecodeAheadVideoDecoder::startDecodeAhead() {
+	// The wrapped decoder starts its clock with the first frame, so
+	// decoding ahead only starts once that has been shown.
+	_started = true;
+
+	// Every tick decodes at most one frame, so other timer callbacks are
+	// held up for one frame at most. The timer manager runs the callback
+	// repeatedly when it falls behind, which helps catching up after
+	// expensive frames.
+	_timerInstalled = g_system->getTimerManager()->installTimerProc(&decodeAheadTimer, 10 * 1000, this);
+	if (!_timerInstalled)
+		warning("DecodeAheadVideoDecoder: Could not install the decoding timer");
+}
+
+void DecodeAheadVideoDecoder::stopDecodeAhead() {
+	if (_timerInstalled) {
+		// removeTimerProc waits for a running callback to finish
+		g_system->getTimerManager()->removeTimerProc(&decodeAheadTimer, this);
+		_timerInstalled = false;
+	}
+
+	if (_started)
+		debug(1, "DecodeAheadVideoDecoder: %d frames, %d late, decoding took %d ms (at most %d ms per frame)",
+		      _stats.frames, _stats.lateFrames, _stats.decodeTime, _stats.maxDecodeTime);
+
+	_started = false;
+}
+
+void DecodeAheadVideoDecoder::decodeAheadTimer(void *refCon) {
+	((DecodeAheadVideoDecoder *)refCon)->decodeAhead();
+}
+
+void DecodeAheadVideoDecoder::decodeAhead() {
+	Common::StackLock decoderLock(_decoderMutex);
+
+	uint slot;
+	{
+		Common::StackLock lock(_queueMutex);
+		if (_queueCount == _numFrames)
+			return;
+
+		slot = (_queueStart + _queueCount) % (_numFrames + 1);
+	}
+
+	// Keep checking, as the end of some videos depends on their audio
+	if (_decoder->endOfVideo()) {
+		Common::StackLock lock(_queueMutex);
+		_decoderFinished = true;
+		return;
+	}
+
+	// The slot is neither queued nor displayed, so it can be filled
+	// without holding the queue lock.
+	decodeFrame(_queue[slot]);
+
+	Common::StackLock lock(_queueMutex);
+	_queueCount++;
+}
+
+void DecodeAheadVideoDecoder::decodeFrame(QueuedFrame &frame) {
+	frame.time = _decoder->getElapsedTime() + _decoder->getTimeToNextFrame();
+
+	const uint32 start = g_system->getMillis();
+	const Graphics::Surface *surface = _decoder->decodeNextFrame();
+	const uint32 decodeTime = g_system->getMillis() - start;
+
+	frame.hasSurface = surface != 0;
+	if (surface) {
+		if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.bytesPerPixel != surface->bytesPerPixel) {
+			frame.surface.free();
+			frame.surface.create(surface->w, surface->h, surface->bytesPerPixel);
+		}
+
+		for (int y = 0; y < surface->h; y++)
+			memcpy(frame.surface.getBasePtr(0, y), surface->getBasePtr(0, y), surface->w * surface->bytesPerPixel);
+	}
+
+	frame.dirtyPalette = _decoder->hasDirtyPalette();
+	if (frame.dirtyPalette)
+		memcpy(frame.palette, _decoder->getPalette(), sizeof(frame.palette));
+
+	const uint32 nextFrameTime = _decoder->getElapsedTime() + _decoder->getTimeToNextFrame();
+	const bool finished = _decoder->endOfVideo();
+
+	Common::StackLock lock(_queueMutex);
+	_nextFrameTime = nextFrameTime;
+	_decoderFinished = finished;
+	_stats.decodeTime += decodeTime;
+	_stats.maxDecodeTime = MAX(_stats.maxDecodeTime, decodeTime);
+}
+
 } // End of namespace Video
@@ -26,6 +26,7 @@
 #ifndef VIDEO_DECODER_H
 #define VIDEO_DECODER_H
 
+#include "common/mutex.h"
 #include "common/str.h"
 
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
@@ -274,6 +275,104 @@ public:
 	virtual uint32 getDuration() const = 0;
 };
 
+/**
+ * A VideoDecoder wrapper that decodes a number of frames ahead of the
+ * one being displayed, so that the time spent in decoding a single
+ * expensive frame does not delay its presentation.
+ *
+ * The frames are decoded from a timer callback, which runs on a
+ * separate thread on most backends, into a pool of surfaces. The
+ * presentation time of every frame is taken from the wrapped decoder
+ * before decoding it, so timing is preserved, including audio sync.
+ * When no frame is ready in time, it is decoded on demand and counted
+ * as late.
+ *
+ * The wrapped decoder must not be used directly while it is wrapped.
+ * Its getElapsedTime() and the queries of the video dimensions, format
+ * and frame count are forwarded without holding the decoding lock, so
+ * they must not depend on the decoding state; this holds for all the
+ * decoders in this directory.
+ */
+class DecodeAheadVideoDecoder : public VideoDecoder {
+public:
+	/**
+	 * Decode performance counters, see getStatistics().
+	 */
+	struct Statistics {
+		uint32 frames;			///< frames returned by decodeNextFrame
+		uint32 lateFrames;		///< frames not decoded ahead in time
+		uint32 decodeTime;		///< total time spent in decoding (in ms)
+		uint32 maxDecodeTime;	///< longest time spent in decoding a frame (in ms)
+	};
+
+	/**
+	 * Create a wrapper that takes ownership of the given decoder.
+	 * @param decoder	the decoder to wrap
+	 * @param frames	the number of frames to decode ahead
+	 */
+	DecodeAheadVideoDecoder(VideoDecoder *decoder, uint frames);
+	~DecodeAheadVideoDecoder();
+
+	bool loadFile(const Common::String &filename);
+	bool loadStream(Common::SeekableReadStream *stream);
+	void close();
+	bool isVideoLoaded() const;
+
+	uint16 getWidth() const;
+	uint16 getHeight() const;
+	Graphics::PixelFormat getPixelFormat() const;
+	const byte *getPalette();
+	bool hasDirtyPalette() const { return _dirtyPalette; }
+	uint32 getFrameCount() const;
+
+	uint32 getElapsedTime() const;
+	uint32 getTimeToNextFrame() const;
+	const Graphics::Surface *decodeNextFrame();
+	bool endOfVideo() const;
+
+	/**
+	 * Return the decode statistics of the currently loaded video.
+	 */
+	Statistics getStatistics() const;
+
+protected:
+	void pauseVideoIntern(bool pause);
+	void addPauseTime(uint32 ms) {}
+
+private:
+	struct QueuedFrame;
+
+	VideoDecoder *_decoder;
+	uint _numFrames;
+
+	// The pool has one more entry than frames decoded ahead, which
+	// holds the frame currently displayed.
+	QueuedFrame *_queue;
+	uint _queueStart;
+	uint _queueCount;
+	uint32 _nextFrameTime;
+	bool _decoderFinished;
+	bool _started;
+	bool _timerInstalled;
+
+	byte _palette[256 * 3];
+	bool _dirtyPalette;
+
+	Statistics _stats;
+
+	// _decoderMutex guards the wrapped decoder, _queueMutex the pool.
+	// Both are taken in this order.
+	Common::Mutex _decoderMutex;
+	mutable Common::Mutex _queueMutex;
+
+	static void decodeAheadTimer(void *refCon);
+
+	void startDecodeAhead();
+	void stopDecodeAhead();
+	void decodeAhead();
+	void decodeFrame(QueuedFrame &frame);
+};
+
 } // End of namespace Video
 
 #endif